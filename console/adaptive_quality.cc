@@ -0,0 +1,146 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/adaptive_quality.h"
+
+#if !defined(OS_WIN)
+#include <sys/ioctl.h>
+#include <termios.h>
+#endif
+
+namespace console {
+
+namespace {
+
+constexpr const AdaptiveQualityController::Quality
+    kQualities[AdaptiveQualityController::kLevels] = {
+        {AdaptiveQualityController::ColorLevel::kTruecolor, 1, 0},
+        {AdaptiveQualityController::ColorLevel::k256Color, 1, 0},
+        {AdaptiveQualityController::ColorLevel::k16Color, 1, 0},
+        {AdaptiveQualityController::ColorLevel::k16Color, 2, 4},
+        {AdaptiveQualityController::ColorLevel::k16Color, 4, 1},
+};
+
+std::atomic<AdaptiveQualityController*> g_current{nullptr};
+
+}  // namespace
+
+constexpr size_t AdaptiveQualityController::kLevels;
+constexpr int AdaptiveQualityController::kRecoverWindows;
+constexpr int AdaptiveQualityController::kCongestedBlockedPermille;
+constexpr int AdaptiveQualityController::kClearBlockedPermille;
+constexpr int AdaptiveQualityController::kCongestedQueuedBytes;
+constexpr int AdaptiveQualityController::kClearQueuedBytes;
+
+AdaptiveQualityController::AdaptiveQualityController()
+    : window_(500), window_start_(std::chrono::steady_clock::now()) {}
+
+AdaptiveQualityController::~AdaptiveQualityController() {
+  AdaptiveQualityController* self = this;
+  g_current.compare_exchange_strong(self, nullptr);
+}
+
+// static
+void AdaptiveQualityController::SetCurrent(
+    AdaptiveQualityController* controller) {
+  g_current.store(controller, std::memory_order_release);
+}
+
+// static
+AdaptiveQualityController* AdaptiveQualityController::GetCurrent() {
+  return g_current.load(std::memory_order_acquire);
+}
+
+void AdaptiveQualityController::set_fd(int fd) { fd_ = fd; }
+
+void AdaptiveQualityController::set_window(std::chrono::milliseconds window) {
+  window_ = window;
+}
+
+void AdaptiveQualityController::RecordWrite(std::chrono::nanoseconds blocked) {
+  blocked_ns_.fetch_add(blocked.count(), std::memory_order_relaxed);
+}
+
+bool AdaptiveQualityController::Evaluate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto now = std::chrono::steady_clock::now();
+  auto elapsed = now - window_start_;
+  if (elapsed < window_ || elapsed.count() == 0) return false;
+  window_start_ = now;
+
+  int64_t blocked_ns = blocked_ns_.exchange(0, std::memory_order_relaxed);
+  int64_t blocked_permille =
+      blocked_ns * 1000 /
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  bool congested = blocked_permille > kCongestedBlockedPermille;
+  bool clear = blocked_permille < kClearBlockedPermille;
+
+  int queued_bytes;
+  if (GetQueuedBytes(&queued_bytes)) {
+    congested |= queued_bytes > kCongestedQueuedBytes;
+    clear &= queued_bytes < kClearQueuedBytes;
+  }
+
+  size_t level = level_.load(std::memory_order_relaxed);
+  if (congested) {
+    clear_windows_ = 0;
+    if (level + 1 < kLevels) {
+      level_.store(level + 1, std::memory_order_relaxed);
+      return true;
+    }
+  } else if (clear) {
+    if (++clear_windows_ >= kRecoverWindows && level > 0) {
+      clear_windows_ = 0;
+      level_.store(level - 1, std::memory_order_relaxed);
+      return true;
+    }
+  } else {
+    clear_windows_ = 0;
+  }
+  return false;
+}
+
+size_t AdaptiveQualityController::level() const {
+  return level_.load(std::memory_order_relaxed);
+}
+
+AdaptiveQualityController::Quality AdaptiveQualityController::quality() const {
+  return kQualities[level()];
+}
+
+std::chrono::milliseconds AdaptiveQualityController::frame_interval(
+    std::chrono::milliseconds base) const {
+  return base * quality().frame_interval_scale;
+}
+
+void AdaptiveQualityController::Apply(Console::Info* info) const {
+  switch (quality().color_level) {
+    case ColorLevel::kTruecolor:
+      break;
+    case ColorLevel::k256Color:
+      if (info->support_truecolor) {
+        info->support_truecolor = false;
+        info->support_8bit_color = true;
+      }
+      break;
+    case ColorLevel::k16Color:
+      if (info->support_truecolor || info->support_8bit_color) {
+        info->support_truecolor = false;
+        info->support_8bit_color = false;
+        info->support_4bit_color = true;
+      }
+      break;
+  }
+}
+
+bool AdaptiveQualityController::GetQueuedBytes(int* queued_bytes) const {
+#if defined(TIOCOUTQ)
+  if (fd_ < 0) return false;
+  return ioctl(fd_, TIOCOUTQ, queued_bytes) == 0;
+#else
+  return false;
+#endif
+}
+
+}  // namespace console
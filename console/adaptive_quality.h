@@ -0,0 +1,112 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_ADAPTIVE_QUALITY_H_
+#define CONSOLE_ADAPTIVE_QUALITY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "console/console.h"
+#include "console/export.h"
+
+namespace console {
+
+// AdaptiveQualityController watches how fast the output drains and lowers
+// the rendering quality when the link can't keep up, for example over SSH or
+// a serial console. Once the link recovers, it raises the quality again.
+//
+// Congestion is measured from the time blocked in Stream::Flush() and, if
+// an fd is given, from the output queue depth reported by TIOCOUTQ.
+//
+// The quality goes down the ladder below one step per congested window and
+// goes up one step after |kRecoverWindows| clear windows in a row.
+//   0: truecolor
+//   1: 256 colors
+//   2: 16 colors
+//   3: 16 colors, half frame rate, at most 4 animated regions
+//   4: 16 colors, quarter frame rate, at most 1 animated region
+class CONSOLE_EXPORT AdaptiveQualityController {
+ public:
+  enum class ColorLevel {
+    k16Color,
+    k256Color,
+    kTruecolor,
+  };
+
+  struct Quality {
+    ColorLevel color_level;
+    // Multiplier applied to the frame interval of animations.
+    int frame_interval_scale;
+    // The maximum number of children an AnimationGroup animates. The others
+    // are drawn as plain text. 0 means no limit.
+    size_t max_animated_regions;
+  };
+
+  static constexpr size_t kLevels = 5;
+  static constexpr int kRecoverWindows = 3;
+  // The link is congested if more than 10% of a window was spent blocked
+  // in writing, and clear if less than 2% was.
+  static constexpr int kCongestedBlockedPermille = 100;
+  static constexpr int kClearBlockedPermille = 20;
+  // The link is congested if more bytes than this are queued, and clear if
+  // less than |kClearQueuedBytes| are.
+  static constexpr int kCongestedQueuedBytes = 4096;
+  static constexpr int kClearQueuedBytes = 256;
+
+  AdaptiveQualityController();
+  AdaptiveQualityController(const AdaptiveQualityController& other) = delete;
+  AdaptiveQualityController& operator=(
+      const AdaptiveQualityController& other) = delete;
+  ~AdaptiveQualityController();
+
+  // Installs |controller| as the one consulted by Stream and AnimationGroup.
+  // Passing nullptr uninstalls it. The caller keeps the ownership.
+  static void SetCurrent(AdaptiveQualityController* controller);
+  static AdaptiveQualityController* GetCurrent();
+
+  // Samples the output queue of |fd|. -1, the default, disables sampling.
+  void set_fd(int fd);
+  // Sets the length of a measurement window. The default is 500ms.
+  void set_window(std::chrono::milliseconds window);
+
+  // Records that a write blocked the caller for |blocked|. Thread safe.
+  void RecordWrite(std::chrono::nanoseconds blocked);
+
+  // Re-evaluates the quality if a window elapsed since the last evaluation.
+  // Returns true if the quality was changed.
+  bool Evaluate();
+
+  // Returns the current step in the ladder. 0 is the best quality.
+  size_t level() const;
+  Quality quality() const;
+
+  // Returns |base| scaled by the current quality.
+  std::chrono::milliseconds frame_interval(
+      std::chrono::milliseconds base) const;
+
+  // Lowers |info| to what the current quality allows.
+  void Apply(Console::Info* info) const;
+
+ private:
+  // Returns false if the queue depth of |fd_| is not available.
+  bool GetQueuedBytes(int* queued_bytes) const;
+
+  int fd_ = -1;
+  std::chrono::milliseconds window_;
+  std::atomic<size_t> level_{0};
+  std::atomic<int64_t> blocked_ns_{0};
+
+  std::mutex mutex_;
+  std::chrono::steady_clock::time_point window_start_;
+  int clear_windows_ = 0;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_ADAPTIVE_QUALITY_H_
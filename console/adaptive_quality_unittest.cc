@@ -0,0 +1,66 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/adaptive_quality.h"
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace console {
+
+namespace {
+
+void WaitAndEvaluate(AdaptiveQualityController& controller,
+                     std::chrono::nanoseconds blocked, bool expected) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  controller.RecordWrite(blocked);
+  EXPECT_EQ(controller.Evaluate(), expected);
+}
+
+}  // namespace
+
+TEST(AdaptiveQualityControllerTest, DowngradeAndRecover) {
+  AdaptiveQualityController controller;
+  controller.set_window(std::chrono::milliseconds(1));
+  EXPECT_EQ(controller.level(), 0);
+
+  for (size_t i = 1; i < AdaptiveQualityController::kLevels; ++i) {
+    WaitAndEvaluate(controller, std::chrono::seconds(1), true);
+    EXPECT_EQ(controller.level(), i);
+  }
+  WaitAndEvaluate(controller, std::chrono::seconds(1), false);
+  EXPECT_EQ(controller.level(), AdaptiveQualityController::kLevels - 1);
+  EXPECT_EQ(controller.quality().color_level,
+            AdaptiveQualityController::ColorLevel::k16Color);
+  EXPECT_EQ(controller.frame_interval(std::chrono::milliseconds(100)),
+            std::chrono::milliseconds(400));
+
+  for (int i = 1; i < AdaptiveQualityController::kRecoverWindows; ++i) {
+    WaitAndEvaluate(controller, std::chrono::nanoseconds(0), false);
+  }
+  WaitAndEvaluate(controller, std::chrono::nanoseconds(0), true);
+  EXPECT_EQ(controller.level(), AdaptiveQualityController::kLevels - 2);
+}
+
+TEST(AdaptiveQualityControllerTest, Apply) {
+  AdaptiveQualityController controller;
+  controller.set_window(std::chrono::milliseconds(1));
+  Console::Info info;
+  info.support_truecolor = true;
+  controller.Apply(&info);
+  EXPECT_TRUE(info.support_truecolor);
+
+  WaitAndEvaluate(controller, std::chrono::seconds(1), true);
+  controller.Apply(&info);
+  EXPECT_FALSE(info.support_truecolor);
+  EXPECT_TRUE(info.support_8bit_color);
+
+  WaitAndEvaluate(controller, std::chrono::seconds(1), true);
+  controller.Apply(&info);
+  EXPECT_FALSE(info.support_8bit_color);
+  EXPECT_TRUE(info.support_4bit_color);
+}
+
+}  // namespace console
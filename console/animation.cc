@@ -6,7 +6,12 @@
 
 #include <algorithm>
 
+#include "console/adaptive_quality.h"
+#include "console/console.h"
+#include "console/metrics.h"
 #include "console/stream.h"
+#include "console/thread_pool.h"
+#include "console/tracing.h"
 
 namespace console {
 
@@ -34,9 +39,23 @@ void Animation::set_on_animation_end(OnAnimationEnd on_animation_end) {
 
 void Animation::set_repeat(bool repeat) { repeat_ = repeat; }
 
-void Animation::Update() {
+void Animation::EnableFrameCache(size_t max_bytes) {
+  frame_cache_.reset(new FrameCache(max_bytes));
+}
+
+void Animation::DisableFrameCache() { frame_cache_.reset(); }
+
+void Animation::Update() { Update(RenderContext::GetDefault()); }
+
+void Animation::Update(RenderContext* context) {
   if (ended_) return;
-  if (!ShouldUpdate()) return;
+  if (!ShouldUpdate()) {
+    CONSOLE_METRICS(Metrics::RecordFrameSkipped());
+    return;
+  }
+
+  CONSOLE_METRICS_SCOPED_FRAME_TIMER(frame_timer);
+  CONSOLE_TRACE_EVENT("Animation::Update");
 
   if (!started_) {
     started_ = true;
@@ -47,12 +66,31 @@ void Animation::Update() {
     on_animation_will_update_(current_frame_);
   }
 
-  DoUpdate();
+  {
+    CONSOLE_TRACE_EVENT("Animation::DoUpdate");
+    Stream& stream = context->stream();
+    stream.RefreshConsoleInfo();
+    DidRefreshConsoleInfo(context);
+    if (reduced_ && repeat_) {
+      DoReducedUpdate(context);
+    } else if (frame_cache_ && repeat_) {
+      DoCachedUpdate(context);
+    } else {
+      DoUpdate(context);
+    }
+    // Attributes set by an animation don't leak into what follows it.
+    stream.Reset();
+  }
 
   if (on_animation_did_update_) {
     on_animation_did_update_(current_frame_);
   }
 
+  if (paused_) {
+    ended_ = false;
+    return;
+  }
+
   current_frame_++;
 
   if (ended_) {
@@ -60,113 +98,510 @@ void Animation::Update() {
   }
 }
 
+void Animation::Seek(size_t frame) {
+  current_frame_ = frame;
+  ended_ = false;
+}
+
+void Animation::SeekToTime(std::chrono::nanoseconds elapsed,
+                           std::chrono::nanoseconds interval) {
+  Seek(interval.count() > 0 ? elapsed / interval : 0);
+}
+
+size_t Animation::current_frame() const { return current_frame_; }
+
+void Animation::Advance(size_t frames) {
+  if (!paused_) current_frame_ += frames;
+}
+
+void Animation::Pause() { paused_ = true; }
+
+void Animation::Resume() { paused_ = false; }
+
+bool Animation::paused() const { return paused_; }
+
+void Animation::DidRefreshConsoleInfo(RenderContext* context) {}
+
+void Animation::DoReducedUpdate(RenderContext* context) {
+  DoUpdate(context);
+}
+
+size_t Animation::GetPeriod() const { return 0; }
+
+void Animation::InvalidateFrames() {
+  if (frame_cache_) frame_cache_->Clear();
+}
+
+void Animation::DoCachedUpdate(RenderContext* context) {
+  size_t period = GetPeriod();
+  if (period == 0) {
+    DoUpdate(context);
+    return;
+  }
+
+  frame_cache_->Prepare(period, context->stream().console_info());
+  size_t frame = current_frame_ % period;
+  absl::string_view bytes;
+  if (frame_cache_->Lookup(frame, &bytes)) {
+    CONSOLE_TRACE_EVENT("Animation::ReplayFrame");
+    CONSOLE_METRICS(Metrics::RecordBytesWritten(bytes.size()));
+    context->target()->Write(bytes.data(), bytes.size());
+    return;
+  }
+
+  // The output of the context can't be read back, so the frame is drawn
+  // into a buffer first.
+  BufferRenderTarget target;
+  RenderContext frame_context(&target);
+  frame_context.set_tick_clock(context->tick_clock());
+  DoUpdate(&frame_context);
+  frame_cache_->Store(frame, target.buffer());
+  context->target()->Write(target.buffer().data(), target.buffer().size());
+}
+
+struct AnimationGroup::ChildOutput {
+  ChildOutput() : context(&target) {}
+
+  BufferRenderTarget target;
+  RenderContext context;
+};
+
 AnimationGroup::AnimationGroup() = default;
 
 AnimationGroup::~AnimationGroup() = default;
 
 void AnimationGroup::AddAnimation(std::unique_ptr<Animation> animation) {
+  animation->removed_ = false;
+  if (paused_) animation->Pause();
   animations_.push_back(std::move(animation));
 }
 
-bool AnimationGroup::ShouldUpdate() { return true; }
+void AnimationGroup::RemoveAnimation(Animation* animation) {
+  if (animation->removed_) return;
+  animation->removed_ = true;
+  removed_count_++;
+}
+
+size_t AnimationGroup::size() const {
+  return animations_.size() - removed_count_;
+}
+
+void AnimationGroup::Seek(size_t frame) {
+  Animation::Seek(frame);
+  for (auto& animation : animations_) animation->Seek(frame);
+}
+
+void AnimationGroup::Advance(size_t frames) {
+  if (paused_) return;
+  Animation::Advance(frames);
+  for (auto& animation : animations_) animation->Advance(frames);
+}
+
+void AnimationGroup::Pause() {
+  Animation::Pause();
+  for (auto& animation : animations_) animation->Pause();
+}
+
+void AnimationGroup::Resume() {
+  Animation::Resume();
+  for (auto& animation : animations_) animation->Resume();
+}
+
+void AnimationGroup::set_thread_pool(ThreadPool* thread_pool) {
+  thread_pool_ = thread_pool;
+}
 
-void AnimationGroup::DoUpdate() {
-  bool ended = false;
+bool AnimationGroup::ShouldUpdate() { return !animations_.empty(); }
 
+void AnimationGroup::DoUpdate(RenderContext* context) {
+  if (removed_count_ > 0) Compact();
+
+  size_t max_animated_regions = 0;
+  AdaptiveQualityController* controller =
+      AdaptiveQualityController::GetCurrent();
+  if (controller) {
+    max_animated_regions = controller->quality().max_animated_regions;
+  }
+
+  size_t i = 0;
   for (auto& animation : animations_) {
-    animation->Update();
-    ended &= animation->ended_;
+    animation->reduced_ =
+        max_animated_regions > 0 && i >= max_animated_regions;
+    i++;
+  }
+
+  if (thread_pool_ && thread_pool_->num_threads() > 0 &&
+      animations_.size() > 1) {
+    UpdateInParallel(context);
+  } else {
+    for (auto& animation : animations_) {
+      CONSOLE_TRACE_EVENT("AnimationGroup::UpdateChild");
+      animation->Update(context);
+    }
+  }
+
+  Compact();
+  if (!repeat_ && animations_.empty()) ended_ = true;
+}
+
+void AnimationGroup::UpdateInParallel(RenderContext* context) {
+  // Console::GetInfo() lazily initializes itself, so it's called once here
+  // before the children refresh their Streams on other threads.
+  Console::GetInfo();
+
+  while (outputs_.size() < animations_.size()) {
+    outputs_.emplace_back(new ChildOutput());
+  }
+  for (size_t i = 0; i < animations_.size(); ++i) {
+    outputs_[i]->context.set_tick_clock(context->tick_clock());
+  }
+
+  thread_pool_->ParallelFor(animations_.size(), [this](size_t i) {
+    CONSOLE_TRACE_EVENT("AnimationGroup::UpdateChild");
+    animations_[i]->Update(&outputs_[i]->context);
+  });
+
+  // The bytes were already counted by Metrics when the children wrote them,
+  // so they are handed to the target directly.
+  for (size_t i = 0; i < animations_.size(); ++i) {
+    BufferRenderTarget& target = outputs_[i]->target;
+    context->target()->Write(target.buffer().data(), target.buffer().size());
+    target.Clear();
   }
+}
 
-  ended_ = ended;
+void AnimationGroup::Compact() {
+  // The sweep is stable, so that the children keep their order on screen.
+  auto it = std::remove_if(animations_.begin(), animations_.end(),
+                           [](const std::unique_ptr<Animation>& animation) {
+                             return animation->ended_ || animation->removed_;
+                           });
+  animations_.erase(it, animations_.end());
+  removed_count_ = 0;
 }
 
 TextAnimation::TextAnimation() = default;
 
 TextAnimation::~TextAnimation() = default;
 
-void TextAnimation::set_text(const std::string& text) { text_ = text; }
+void TextAnimation::set_text(const std::string& text) {
+  text_ = text;
+  UpdateLineStarts();
+  InvalidateFrames();
+}
 
-void TextAnimation::set_text(std::string&& text) { text_ = std::move(text); }
+void TextAnimation::set_text(std::string&& text) {
+  text_ = std::move(text);
+  UpdateLineStarts();
+  InvalidateFrames();
+}
 
 const std::string& TextAnimation::text() const { return text_; }
 
+void TextAnimation::set_delta_rendering(bool delta_rendering) {
+  delta_rendering_ = delta_rendering;
+  InvalidateFrames();
+}
+
+void TextAnimation::set_viewport(const Viewport& viewport) {
+  viewport_ = viewport;
+  has_viewport_ = true;
+  InvalidateFrames();
+}
+
+void TextAnimation::ClearViewport() {
+  has_viewport_ = false;
+  InvalidateFrames();
+}
+
+void TextAnimation::ScrollTo(size_t row, size_t column) {
+  viewport_.row = row;
+  viewport_.column = column;
+  InvalidateFrames();
+}
+
+bool TextAnimation::has_viewport() const { return has_viewport_; }
+
+const TextAnimation::Viewport& TextAnimation::viewport() const {
+  return viewport_;
+}
+
+size_t TextAnimation::GetLineCount() const { return line_starts_.size(); }
+
+void TextAnimation::DoReducedUpdate(RenderContext* context) {
+  if (has_viewport_) {
+    DrawViewport(context, false);
+    return;
+  }
+  context->stream().Write(text_);
+}
+
+void TextAnimation::DidRefreshConsoleInfo(RenderContext* context) {
+  if (!has_viewport_ || (viewport_.columns != 0 && viewport_.rows != 0)) {
+    return;
+  }
+  size_t columns = 80;
+  size_t rows = 24;
+  context->target()->GetWindowSize(&columns, &rows);
+  if (columns == window_columns_ && rows == window_rows_) return;
+  window_columns_ = columns;
+  window_rows_ = rows;
+  InvalidateFrames();
+}
+
+void TextAnimation::InvalidateFrames() {
+  Animation::InvalidateFrames();
+  cells_valid_ = false;
+}
+
+void TextAnimation::DrawFrame(RenderContext* context) {
+  Stream* stream = &context->stream();
+  if (has_viewport_) {
+    DrawViewport(context, true);
+    has_drawn_ = false;
+    cells_valid_ = false;
+    return;
+  }
+
+  bool delta = delta_rendering_ && text_.find('\n') == std::string::npos;
+  if (delta && has_drawn_) {
+    changed_cells_.clear();
+    if (cells_valid_ && GetChangedCells(drawn_frame_, &changed_cells_)) {
+      size_t cursor = drawn_length_;
+      for (const CellRange& range : changed_cells_) {
+        MoveCursor(stream, cursor, range.begin);
+        DrawCells(stream, range.begin, range.end);
+        cursor = range.end;
+      }
+      MoveCursor(stream, cursor, text_.length());
+      drawn_frame_ = current_frame_;
+      return;
+    }
+
+    // Goes back to where the last frame started and draws over it.
+    MoveCursor(stream, drawn_length_, 0);
+    stream->EraseEndOfLine();
+  }
+
+  DrawCells(stream, 0, text_.length());
+  has_drawn_ = delta;
+  cells_valid_ = true;
+  drawn_frame_ = current_frame_;
+  drawn_length_ = text_.length();
+}
+
+void TextAnimation::DrawViewport(RenderContext* context, bool attributes) {
+  Stream* stream = &context->stream();
+  size_t columns = viewport_.columns;
+  size_t rows = viewport_.rows;
+  if (columns == 0) columns = window_columns_;
+  if (rows == 0) rows = window_rows_;
+  // The frame doesn't get taller than the text, so that short text isn't
+  // followed by blank lines.
+  rows = std::min(rows, line_starts_.size());
+
+  for (size_t i = 0; i < rows; ++i) {
+    size_t line = viewport_.row + i;
+    if (line < line_starts_.size()) {
+      size_t line_end = line + 1 < line_starts_.size()
+                            ? line_starts_[line + 1] - 1
+                            : text_.length();
+      // Only the last line may still end with a newline.
+      if (line_end > line_starts_[line] && text_[line_end - 1] == '\n') {
+        line_end--;
+      }
+      size_t begin = std::min(line_starts_[line] + viewport_.column, line_end);
+      size_t end = std::min(begin + columns, line_end);
+      if (begin < end) {
+        if (attributes) {
+          DrawCells(stream, begin, end);
+        } else {
+          TextAnimation::DrawCells(stream, begin, end);
+        }
+      }
+    }
+    stream->EraseEndOfLine();
+    stream->Write('\n');
+  }
+}
+
+void TextAnimation::DrawCells(Stream* stream, size_t begin, size_t end) {
+  stream->Write(absl::string_view(text_).substr(begin, end - begin));
+}
+
+bool TextAnimation::GetChangedCells(size_t previous_frame,
+                                    std::vector<CellRange>* ranges) const {
+  return false;
+}
+
+void TextAnimation::UpdateLineStarts() {
+  line_starts_.clear();
+  size_t start = 0;
+  while (start < text_.length()) {
+    line_starts_.push_back(start);
+    size_t newline = text_.find('\n', start);
+    if (newline == std::string::npos) break;
+    start = newline + 1;
+  }
+}
+
+// static
+void TextAnimation::MoveCursor(Stream* stream, size_t from, size_t to) {
+  // Note that moving by 0 moves by 1.
+  if (to < from) {
+    stream->CursorBackward(from - to);
+  } else if (to > from) {
+    stream->CursorForward(to - from);
+  }
+}
+
 FlowTextAnimation::FlowTextAnimation() = default;
 
 FlowTextAnimation::~FlowTextAnimation() = default;
 
 void FlowTextAnimation::set_colors(const std::vector<color::Rgb>& colors) {
   colors_ = colors;
+  InvalidateFrames();
 }
 
 void FlowTextAnimation::set_colors(std::vector<color::Rgb>&& colors) {
   colors_ = std::move(colors);
+  InvalidateFrames();
 }
 
 const std::vector<color::Rgb>& FlowTextAnimation::colors() const {
   return colors_;
 }
 
+void FlowTextAnimation::set_timeline(const ColorTimeline& timeline) {
+  timeline_ = timeline;
+  InvalidateFrames();
+}
+
+const ColorTimeline& FlowTextAnimation::timeline() const { return timeline_; }
+
 bool FlowTextAnimation::ShouldUpdate() {
-  if (colors_.size() == 0) return false;
+  if (colors_.size() == 0 && timeline_.empty()) return false;
   if (text_.length() == 0) return false;
   return true;
 }
 
-void FlowTextAnimation::DoUpdate() {
-  console::Stream stream;
-  size_t c = current_frame_ % colors_.size();
-  for (size_t i = 0; i < text_.length(); ++i) {
-    stream.Rgb(colors_[(c + i) % colors_.size()]);
-    std::cout << text_[i];
-  }
+void FlowTextAnimation::DoUpdate(RenderContext* context) {
+  DrawFrame(context);
 
   if (!repeat_) {
-    if (current_frame_ == text_.length() - 1) {
+    if (current_frame_ >= text_.length() - 1) {
       ended_ = true;
     }
   }
 }
 
+size_t FlowTextAnimation::GetPeriod() const {
+  // A delta frame depends on the previous frame as well.
+  if (delta_rendering_) return 0;
+  return GetColorPeriod();
+}
+
+size_t FlowTextAnimation::GetColorPeriod() const {
+  if (!timeline_.empty()) return std::max<size_t>(timeline_.duration(), 1);
+  return colors_.size();
+}
+
+void FlowTextAnimation::DrawCells(Stream* stream, size_t begin, size_t end) {
+  size_t period = GetColorPeriod();
+  size_t c = current_frame_ % period;
+  if (!timeline_.empty()) {
+    // Only the cells drawn are evaluated.
+    times_.resize(end - begin);
+    cell_colors_.resize(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+      times_[i - begin] = static_cast<uint32_t>((c + i) % period);
+    }
+    timeline_.Evaluate(times_.data(), times_.size(), cell_colors_.data());
+    for (size_t i = begin; i < end; ++i) {
+      stream->Rgb(cell_colors_[i - begin], i, 0);
+      stream->Write(text_[i]);
+    }
+  } else {
+    for (size_t i = begin; i < end; ++i) {
+      stream->Rgb(colors_[(c + i) % period], i, 0);
+      stream->Write(text_[i]);
+    }
+  }
+  stream->ColorOff();
+}
+
 NeonTextAnimation::NeonTextAnimation() = default;
 
 NeonTextAnimation::~NeonTextAnimation() = default;
 
 void NeonTextAnimation::set_colors(const std::vector<color::Rgb>& colors) {
   colors_ = colors;
+  InvalidateFrames();
 }
 
 void NeonTextAnimation::set_colors(std::vector<color::Rgb>&& colors) {
   colors_ = std::move(colors);
+  InvalidateFrames();
 }
 
 const std::vector<color::Rgb>& NeonTextAnimation::colors() const {
   return colors_;
 }
 
+void NeonTextAnimation::set_timeline(const ColorTimeline& timeline) {
+  timeline_ = timeline;
+  InvalidateFrames();
+}
+
+const ColorTimeline& NeonTextAnimation::timeline() const { return timeline_; }
+
 bool NeonTextAnimation::ShouldUpdate() {
-  if (colors_.size() == 0) return false;
+  if (colors_.size() == 0 && timeline_.empty()) return false;
   if (text_.length() == 0) return false;
   return true;
 }
 
-void NeonTextAnimation::DoUpdate() {
-  console::Stream stream;
-  stream.Rgb(colors_[current_frame_ % colors_.size()]);
-  std::cout << text_;
+void NeonTextAnimation::DoUpdate(RenderContext* context) {
+  DrawFrame(context);
 
   if (!repeat_) {
-    if (current_frame_ == colors_.size() - 1) {
+    if (current_frame_ >= GetColorPeriod() - 1) {
       ended_ = true;
     }
   }
 }
 
+size_t NeonTextAnimation::GetPeriod() const {
+  // A delta frame depends on the previous frame as well.
+  if (delta_rendering_) return 0;
+  return GetColorPeriod();
+}
+
+size_t NeonTextAnimation::GetColorPeriod() const {
+  if (!timeline_.empty()) return std::max<size_t>(timeline_.duration(), 1);
+  return colors_.size();
+}
+
+void NeonTextAnimation::DrawCells(Stream* stream, size_t begin, size_t end) {
+  size_t c = current_frame_ % GetColorPeriod();
+  if (!timeline_.empty()) {
+    stream->Rgb(timeline_.Evaluate(static_cast<uint32_t>(c)));
+  } else {
+    stream->Rgb(colors_[c]);
+  }
+  stream->Write(absl::string_view(text_).substr(begin, end - begin));
+  stream->ColorOff();
+}
+
 KaraokeTextAnimation::KaraokeTextAnimation() = default;
 
 KaraokeTextAnimation::~KaraokeTextAnimation() = default;
 
-void KaraokeTextAnimation::set_color(color::Rgb color) { color_ = color; }
+void KaraokeTextAnimation::set_color(color::Rgb color) {
+  color_ = color;
+  InvalidateFrames();
+}
 
 color::Rgb KaraokeTextAnimation::color() const { return color_; }
 
@@ -175,36 +610,59 @@ bool KaraokeTextAnimation::ShouldUpdate() {
   return true;
 }
 
-void KaraokeTextAnimation::DoUpdate() {
-  size_t i = 0;
-  {
-    console::Stream stream;
-    stream.Rgb(color_);
-    for (; i < current_frame_ % text_.length(); ++i) {
-      std::cout << text_[i];
-    }
-  }
-  for (; i < text_.length(); ++i) {
-    std::cout << text_[i];
-  }
+void KaraokeTextAnimation::DoUpdate(RenderContext* context) {
+  DrawFrame(context);
 
   if (!repeat_) {
-    if (current_frame_ == text_.length() - 1) {
+    if (current_frame_ >= text_.length() - 1) {
       ended_ = true;
     }
   }
 }
 
+size_t KaraokeTextAnimation::GetPeriod() const {
+  // A delta frame depends on the previous frame as well.
+  if (delta_rendering_) return 0;
+  return text_.length();
+}
+
+void KaraokeTextAnimation::DrawCells(Stream* stream, size_t begin,
+                                     size_t end) {
+  absl::string_view text(text_);
+  // The first |i| cells are colored.
+  size_t i = current_frame_ % text_.length();
+  if (begin < std::min(end, i)) {
+    stream->Rgb(color_);
+    stream->Write(text.substr(begin, std::min(end, i) - begin));
+    stream->ColorOff();
+  }
+  if (std::max(begin, i) < end) {
+    stream->Write(text.substr(std::max(begin, i), end - std::max(begin, i)));
+  }
+}
+
+bool KaraokeTextAnimation::GetChangedCells(
+    size_t previous_frame, std::vector<CellRange>* ranges) const {
+  size_t previous = previous_frame % text_.length();
+  size_t i = current_frame_ % text_.length();
+  if (previous != i) {
+    ranges->push_back({std::min(previous, i), std::max(previous, i)});
+  }
+  return true;
+}
+
 RadarTextAnimation::RadarTextAnimation() = default;
 
 RadarTextAnimation::~RadarTextAnimation() = default;
 
 void RadarTextAnimation::set_colors(const std::vector<color::Rgb>& colors) {
   colors_ = colors;
+  InvalidateFrames();
 }
 
 void RadarTextAnimation::set_colors(std::vector<color::Rgb>&& colors) {
   colors_ = std::move(colors);
+  InvalidateFrames();
 }
 
 const std::vector<color::Rgb>& RadarTextAnimation::colors() const {
@@ -217,30 +675,70 @@ bool RadarTextAnimation::ShouldUpdate() {
   return true;
 }
 
-void RadarTextAnimation::DoUpdate() {
-  console::Stream stream;
-  stream.Conceal();
-  size_t i = 0;
+void RadarTextAnimation::DoUpdate(RenderContext* context) {
+  DrawFrame(context);
+
+  if (!repeat_) {
+    if (current_frame_ >= text_.length() - 1) {
+      ended_ = true;
+    }
+  }
+}
+
+size_t RadarTextAnimation::GetPeriod() const {
+  // A delta frame depends on the previous frame as well.
+  if (delta_rendering_) return 0;
+  return text_.length();
+}
+
+void RadarTextAnimation::DrawCells(Stream* stream, size_t begin,
+                                   size_t end) {
+  absl::string_view text(text_);
+  // The cells in [|offset|, |window_end|) are colored and the others are
+  // concealed.
   size_t offset = current_frame_ % text_.length();
-  for (; i < offset; ++i) {
-    std::cout << text_[i];
+  size_t window_end = std::min(text_.length(), offset + colors_.size());
+  if (begin < std::min(end, offset)) {
+    stream->Conceal();
+    stream->Write(text.substr(begin, std::min(end, offset) - begin));
+    stream->ConcealOff();
   }
-  stream.ConcealOff();
-  for (; i < text_.length() && i - offset < colors_.size(); ++i) {
-    stream.Rgb(colors_[i - offset]);
-    std::cout << text_[i];
+  size_t i = std::max(begin, offset);
+  if (i < std::min(end, window_end)) {
+    for (; i < std::min(end, window_end); ++i) {
+      stream->Rgb(colors_[i - offset]);
+      stream->Write(text_[i]);
+    }
+    stream->ColorOff();
   }
-  stream.ColorOff();
-  stream.Conceal();
-  for (; i < text_.length(); ++i) {
-    std::cout << text_[i];
+  i = std::max(begin, window_end);
+  if (i < end) {
+    stream->Conceal();
+    stream->Write(text.substr(i, end - i));
+    stream->ConcealOff();
   }
+}
 
-  if (!repeat_) {
-    if (current_frame_ == text_.length() - 1) {
-      ended_ = true;
-    }
+bool RadarTextAnimation::GetChangedCells(
+    size_t previous_frame, std::vector<CellRange>* ranges) const {
+  size_t previous = previous_frame % text_.length();
+  size_t offset = current_frame_ % text_.length();
+  if (previous == offset) return true;
+
+  // Both the previous and the current window changed.
+  CellRange windows[] = {
+      {previous, std::min(text_.length(), previous + colors_.size())},
+      {offset, std::min(text_.length(), offset + colors_.size())},
+  };
+  if (windows[0].begin > windows[1].begin) std::swap(windows[0], windows[1]);
+  if (windows[0].end >= windows[1].begin) {
+    ranges->push_back(
+        {windows[0].begin, std::max(windows[0].end, windows[1].end)});
+  } else {
+    ranges->push_back(windows[0]);
+    ranges->push_back(windows[1]);
   }
+  return true;
 }
 
 }  // namespace console
\ No newline at end of file
@@ -5,16 +5,22 @@
 #ifndef CONSOLE_ANIMATION_H_
 #define CONSOLE_ANIMATION_H_
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "color/color.h"
+#include "console/color_timeline.h"
 #include "console/export.h"
+#include "console/frame_cache.h"
+#include "console/render_context.h"
 
 namespace console {
 
+class ThreadPool;
+
 class CONSOLE_EXPORT Animation {
  public:
   typedef std::function<void()> OnAnimationStart;
@@ -33,36 +39,131 @@ class CONSOLE_EXPORT Animation {
   void set_on_animation_end(OnAnimationEnd on_animation_end);
   void set_repeat(bool repeat);
 
+  // Caches the bytes of each frame of a repeating animation with a period,
+  // and replays them instead of calling DoUpdate() again. The frames are
+  // kept up to |max_bytes|. See GetPeriod().
+  void EnableFrameCache(size_t max_bytes = FrameCache::kDefaultMaxBytes);
+  void DisableFrameCache();
+
+  // Draws the next frame with |context|. Children of an AnimationGroup are
+  // drawn with the context of the group.
+  void Update(RenderContext* context);
+  // Same as above, but draws to std::cout with RenderContext::GetDefault().
   void Update();
 
+  // Makes the next Update() draw |frame|, without drawing the frames in
+  // between. Every predefined animation draws a frame from its number alone,
+  // so this is O(1) and can go backwards as well. An animation which ended
+  // runs again. An AnimationGroup seeks its children too.
+  virtual void Seek(size_t frame);
+  // Seeks to the frame due |elapsed| after the first frame, when a frame is
+  // drawn every |interval|.
+  void SeekToTime(std::chrono::nanoseconds elapsed,
+                  std::chrono::nanoseconds interval);
+  // Returns the frame the next Update() draws.
+  size_t current_frame() const;
+  // Moves |frames| frames ahead without drawing them, as if they had been
+  // drawn. Unlike Seek(), an AnimationGroup moves each child ahead of its
+  // own frame, and a paused animation stays where it is.
+  virtual void Advance(size_t frames);
+
+  // While paused, Update() keeps drawing the same frame, and the animation
+  // doesn't end. An AnimationGroup pauses its children too.
+  virtual void Pause();
+  virtual void Resume();
+  bool paused() const;
+
  protected:
   friend class AnimationGroup;
+  friend class AnimationScheduler;
 
   virtual bool ShouldUpdate() = 0;
-  virtual void DoUpdate() = 0;
+  virtual void DoUpdate(RenderContext* context) = 0;
+  // Called on every Update() right after the console info of |context| is
+  // refreshed, before the frame is drawn. It does nothing by default.
+  virtual void DidRefreshConsoleInfo(RenderContext* context);
+  // Called instead of DoUpdate() when the output is congested and the
+  // animation was chosen not to be animated. See AdaptiveQualityController.
+  // This is only called for animations with |repeat_|, because the others
+  // usually decide when to end in DoUpdate(). By default, it calls
+  // DoUpdate().
+  virtual void DoReducedUpdate(RenderContext* context);
+  // Returns the number of frames after which a repeating animation draws
+  // the same frame again, or 0 if it doesn't. The frame cache relies on
+  // this, so an animation returning non-zero must draw frames that only
+  // depend on |current_frame_| modulo the period.
+  virtual size_t GetPeriod() const;
+  // Subclasses call this when something the frames depend on changes. It
+  // drops the frame cache.
+  virtual void InvalidateFrames();
 
   OnAnimationStart on_animation_start_;
   OnAnimationWillUpdate on_animation_will_update_;
   OnAnimationDidUpdate on_animation_did_update_;
   OnAnimationEnd on_animation_end_;
+  std::unique_ptr<FrameCache> frame_cache_;
   size_t current_frame_ = 0;
   bool repeat_ = false;
   bool started_ = false;
   bool ended_ = false;
+  bool reduced_ = false;
+  bool paused_ = false;
+  // Set by AnimationGroup::RemoveAnimation().
+  bool removed_ = false;
+
+ private:
+  void DoCachedUpdate(RenderContext* context);
 };
 
+// AnimationGroup updates its children together. Children are destroyed once
+// they end, and the group ends when every child has ended unless it is set
+// to repeat. A repeating group keeps running while it has no children, so
+// that animations can be added to it later.
 class CONSOLE_EXPORT AnimationGroup : public Animation {
  public:
   AnimationGroup();
   ~AnimationGroup() override;
 
+  // Adds and removes children. They take effect from the next frame, so they
+  // must not be called while the group is being updated, for example from
+  // the callbacks of its children.
   void AddAnimation(std::unique_ptr<Animation> animation);
+  // Marks |animation|, which must be a child, to be removed. It is destroyed
+  // at the next frame.
+  void RemoveAnimation(Animation* animation);
+
+  // Returns the number of children that are neither ended nor removed yet.
+  size_t size() const;
+
+  void Seek(size_t frame) override;
+  void Advance(size_t frames) override;
+  void Pause() override;
+  void Resume() override;
+
+  // If |thread_pool| is set, children are updated in parallel on it. Each
+  // child is drawn into its own buffer and the buffers are written in the
+  // order the children were added, so the output is the same as updating
+  // them one by one. Note that the callbacks of children are then called
+  // on the threads of |thread_pool|. The caller keeps the ownership.
+  void set_thread_pool(ThreadPool* thread_pool);
 
  private:
+  struct ChildOutput;
+
   bool ShouldUpdate() override;
-  void DoUpdate() override;
+  void DoUpdate(RenderContext* context) override;
+
+  void UpdateInParallel(RenderContext* context);
+  // Destroys the children which ended or were removed, keeping the order of
+  // the rest.
+  void Compact();
 
+  // Only the active children are kept, in the order they were added.
   std::vector<std::unique_ptr<Animation>> animations_;
+  size_t removed_count_ = 0;
+  ThreadPool* thread_pool_ = nullptr;
+  // Per child output used by UpdateInParallel().
+  std::vector<std::unique_ptr<ChildOutput>> outputs_;
 };
 
 class CONSOLE_EXPORT TextAnimation : public Animation {
@@ -75,8 +176,96 @@ class CONSOLE_EXPORT TextAnimation : public Animation {
 
   const std::string& text() const;
 
+  // Draws only the cells changed since the previous frame and moves the
+  // cursor over the rest, instead of redrawing the whole text. It is up to
+  // the animation to tell what changed, see GetChangedCells(). This works
+  // only if |text_| is on a single line and nothing else moves the cursor
+  // between frames. Otherwise, the whole text is drawn.
+  void set_delta_rendering(bool delta_rendering);
+
+  // The part of the text to draw, in lines and columns.
+  struct Viewport {
+    // The first line and column to draw.
+    size_t row = 0;
+    size_t column = 0;
+    // The number of lines and columns to draw. 0 means the size of the
+    // terminal.
+    size_t rows = 0;
+    size_t columns = 0;
+  };
+
+  // Draws only |viewport| of the text, which is useful for text much larger
+  // than the screen. Each line is cut to the columns of |viewport| and ends
+  // with a newline. Only the visible cells are computed, so the cost of a
+  // frame depends on the size of the viewport rather than the size of the
+  // text. Delta rendering is not used with a viewport, and with the frame
+  // cache, the viewport should have an explicit size.
+  void set_viewport(const Viewport& viewport);
+  void ClearViewport();
+  // Moves the viewport in O(1).
+  void ScrollTo(size_t row, size_t column);
+
+  bool has_viewport() const;
+  const Viewport& viewport() const;
+  // Returns the number of lines of the text. A trailing newline doesn't
+  // start a new line.
+  size_t GetLineCount() const;
+
  protected:
+  // A range of cells, [begin, end), in |text_|.
+  struct CellRange {
+    size_t begin;
+    size_t end;
+  };
+
+  // Draws |text_| without any attributes.
+  void DoReducedUpdate(RenderContext* context) override;
+  // Re-reads the window size for a viewport without an explicit size, and
+  // drops the frames drawn with the old size if the terminal was resized.
+  void DidRefreshConsoleInfo(RenderContext* context) override;
+  void InvalidateFrames() override;
+
+  // Draws the current frame, only the changed cells if possible. If there's
+  // a viewport, this draws the viewport instead.
+  void DrawFrame(RenderContext* context);
+  // Draws the lines in the viewport with DrawCells(), or without attributes
+  // if |attributes| is false. A viewport without an explicit size takes the
+  // size of the terminal behind the target of |context|.
+  void DrawViewport(RenderContext* context, bool attributes);
+  // Draws the cells in [|begin|, |end|) of the current frame and turns off
+  // the attributes it used. By default, it draws them without attributes.
+  virtual void DrawCells(Stream* stream, size_t begin, size_t end);
+  // Appends the ranges of the cells changed between |previous_frame| and
+  // the current frame to |ranges| in ascending order, not overlapping each
+  // other. Returns false if it's unknown, which is the default.
+  virtual bool GetChangedCells(size_t previous_frame,
+                               std::vector<CellRange>* ranges) const;
+
   std::string text_;
+  bool delta_rendering_ = false;
+
+ private:
+  // Moves the cursor from the cell |from| to the cell |to| on the same line.
+  static void MoveCursor(Stream* stream, size_t from, size_t to);
+
+  void UpdateLineStarts();
+
+  // The offset of the first cell of every line in |text_|.
+  std::vector<size_t> line_starts_;
+  bool has_viewport_ = false;
+  Viewport viewport_;
+  // The size of the terminal the last frame was drawn to, or 80x24 if it
+  // isn't a terminal. It is re-read on every Update().
+  size_t window_columns_ = 80;
+  size_t window_rows_ = 24;
+
+  // True if the cursor is right after the last frame drawn in delta mode.
+  bool has_drawn_ = false;
+  // False if the cells of the last frame no longer tell what is on screen.
+  bool cells_valid_ = false;
+  size_t drawn_frame_ = 0;
+  size_t drawn_length_ = 0;
+  std::vector<CellRange> changed_cells_;
 };
 
 class CONSOLE_EXPORT FlowTextAnimation : public TextAnimation {
@@ -89,11 +278,28 @@ class CONSOLE_EXPORT FlowTextAnimation : public TextAnimation {
 
   const std::vector<color::Rgb>& colors() const;
 
+  // Takes colors from |timeline| instead of colors(), one time unit per
+  // frame. The animation repeats every timeline.duration() frames, so a
+  // looping timeline ends with the color it starts with.
+  void set_timeline(const ColorTimeline& timeline);
+
+  const ColorTimeline& timeline() const;
+
  protected:
   bool ShouldUpdate() override;
-  void DoUpdate() override;
+  void DoUpdate(RenderContext* context) override;
+  size_t GetPeriod() const override;
+  void DrawCells(Stream* stream, size_t begin, size_t end) override;
+
+  // The number of frames after which the colors repeat. Unlike
+  // GetPeriod(), it doesn't depend on delta rendering.
+  size_t GetColorPeriod() const;
 
   std::vector<color::Rgb> colors_;
+  ColorTimeline timeline_;
+  // Scratch space to evaluate |timeline_| for every cell of a frame.
+  std::vector<uint32_t> times_;
+  std::vector<color::Rgb> cell_colors_;
 };
 
 class CONSOLE_EXPORT NeonTextAnimation : public TextAnimation {
@@ -106,11 +312,25 @@ class CONSOLE_EXPORT NeonTextAnimation : public TextAnimation {
 
   const std::vector<color::Rgb>& colors() const;
 
+  // Takes colors from |timeline| instead of colors(), one time unit per
+  // frame. The animation repeats every timeline.duration() frames, so a
+  // looping timeline ends with the color it starts with.
+  void set_timeline(const ColorTimeline& timeline);
+
+  const ColorTimeline& timeline() const;
+
  protected:
   bool ShouldUpdate() override;
-  void DoUpdate() override;
+  void DoUpdate(RenderContext* context) override;
+  size_t GetPeriod() const override;
+  void DrawCells(Stream* stream, size_t begin, size_t end) override;
+
+  // The number of frames after which the colors repeat. Unlike
+  // GetPeriod(), it doesn't depend on delta rendering.
+  size_t GetColorPeriod() const;
 
   std::vector<color::Rgb> colors_;
+  ColorTimeline timeline_;
 };
 
 class CONSOLE_EXPORT KaraokeTextAnimation : public TextAnimation {
@@ -124,7 +344,11 @@ class CONSOLE_EXPORT KaraokeTextAnimation : public TextAnimation {
 
  protected:
   bool ShouldUpdate() override;
-  void DoUpdate() override;
+  void DoUpdate(RenderContext* context) override;
+  size_t GetPeriod() const override;
+  void DrawCells(Stream* stream, size_t begin, size_t end) override;
+  bool GetChangedCells(size_t previous_frame,
+                       std::vector<CellRange>* ranges) const override;
 
   color::Rgb color_;
 };
@@ -141,7 +365,11 @@ class CONSOLE_EXPORT RadarTextAnimation : public TextAnimation {
 
  protected:
   bool ShouldUpdate() override;
-  void DoUpdate() override;
+  void DoUpdate(RenderContext* context) override;
+  size_t GetPeriod() const override;
+  void DrawCells(Stream* stream, size_t begin, size_t end) override;
+  bool GetChangedCells(size_t previous_frame,
+                       std::vector<CellRange>* ranges) const override;
 
   std::vector<color::Rgb> colors_;
 };
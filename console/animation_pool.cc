@@ -0,0 +1,284 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/animation_pool.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "console/adaptive_quality.h"
+#include "console/sgr_parameters.h"
+#include "console/tracing.h"
+
+namespace console {
+
+namespace {
+
+constexpr uint32_t kDropped = UINT32_MAX;
+
+// Returns the color support of |info| as a number to compare.
+int GetColorSupport(const Console::Info& info) {
+  return info.support_truecolor << 2 | info.support_8bit_color << 1 |
+         info.support_4bit_color;
+}
+
+// The SGR parameters an element writes besides its colors, and the length of
+// the longest of them: kColorOff, kConceal and kConcealOff.
+constexpr size_t kMaxSgrParametersPerElement = 5;
+constexpr size_t kMaxSgrParameterLength = 5;
+
+char* AppendText(char* out, absl::string_view text) {
+  memcpy(out, text.data(), text.length());
+  CONSOLE_METRICS(Metrics::RecordBytesWritten(text.length()));
+  return out + text.length();
+}
+
+char* AppendEscape(char* out, EscapeKind kind, absl::string_view escape) {
+  if (escape.empty()) return out;
+  memcpy(out, escape.data(), escape.length());
+  CONSOLE_METRICS(Metrics::RecordEscape(kind, escape.length()));
+  return out + escape.length();
+}
+
+}  // namespace
+
+AnimationPool::AnimationPool() = default;
+
+AnimationPool::~AnimationPool() = default;
+
+uint32_t AnimationPool::AddPalette(const std::vector<color::Rgb>& colors) {
+  palettes_.push_back({static_cast<uint32_t>(colors_.size()),
+                       static_cast<uint32_t>(colors.size())});
+  colors_.insert(colors_.end(), colors.begin(), colors.end());
+  return static_cast<uint32_t>(palettes_.size() - 1);
+}
+
+AnimationPool::ElementId AnimationPool::Add(Effect effect,
+                                            absl::string_view text,
+                                            uint32_t palette, bool repeat) {
+  uint32_t length = static_cast<uint32_t>(text.length());
+  uint32_t end_frame = length;
+  if (effect == Effect::kNeon) end_frame = palettes_[palette].size;
+
+  ElementId id = static_cast<ElementId>(indices_.size());
+  indices_.push_back(static_cast<uint32_t>(ids_.size()));
+  text_offsets_.push_back(static_cast<uint32_t>(text_.size()));
+  text_lengths_.push_back(length);
+  frames_.push_back(0);
+  end_frames_.push_back(end_frame);
+  palette_indices_.push_back(palette);
+  effects_.push_back(effect);
+  flags_.push_back(repeat ? kRepeat : 0);
+  ids_.push_back(id);
+  text_.append(text.data(), text.length());
+  return id;
+}
+
+void AnimationPool::Remove(ElementId id) {
+  uint32_t index = indices_[id];
+  if (index == kDropped || (flags_[index] & (kEnded | kRemoved))) return;
+  flags_[index] |= kRemoved;
+  inactive_count_++;
+}
+
+size_t AnimationPool::size() const { return ids_.size() - inactive_count_; }
+
+void AnimationPool::Step() {
+  size_t n = frames_.size();
+  uint32_t* frames = frames_.data();
+  // Kept free of branches, so that the compiler can vectorize it.
+  for (size_t i = 0; i < n; ++i) {
+    frames[i]++;
+  }
+  MarkEnded();
+}
+
+void AnimationPool::MarkEnded() {
+  size_t n = frames_.size();
+  const uint32_t* frames = frames_.data();
+  const uint32_t* end_frames = end_frames_.data();
+  uint8_t* flags = flags_.data();
+  // Kept free of branches, like Step().
+  size_t ended_count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    uint8_t ended = (flags[i] & (kRepeat | kEnded | kRemoved)) == 0 &&
+                    frames[i] >= end_frames[i];
+    flags[i] |= ended * kEnded;
+    ended_count += ended;
+  }
+  inactive_count_ += ended_count;
+}
+
+void AnimationPool::Seek(size_t frame) {
+  Animation::Seek(frame);
+  std::fill(frames_.begin(), frames_.end(), static_cast<uint32_t>(frame));
+}
+
+void AnimationPool::Advance(size_t frames) {
+  if (paused_) return;
+  Animation::Advance(frames);
+  for (uint32_t& frame : frames_) frame += static_cast<uint32_t>(frames);
+  MarkEnded();
+}
+
+bool AnimationPool::ShouldUpdate() { return !ids_.empty(); }
+
+void AnimationPool::DoUpdate(RenderContext* context) {
+  Compact();
+
+  size_t max_animated_regions = 0;
+  AdaptiveQualityController* controller =
+      AdaptiveQualityController::GetCurrent();
+  if (controller) {
+    max_animated_regions = controller->quality().max_animated_regions;
+  }
+
+  {
+    CONSOLE_TRACE_EVENT("AnimationPool::Draw");
+    const Stream& stream = context->stream();
+    UpdateEscapes(stream);
+    // Each character takes at most an escape, and each element adds a few
+    // SGR parameters around them.
+    size_t max_size = text_.size() * (max_escape_length_ + 1) +
+                      ids_.size() * kMaxSgrParametersPerElement *
+                          kMaxSgrParameterLength;
+    if (frame_.size() < max_size) frame_.resize(max_size);
+    char* begin = &frame_[0];
+    char* end = begin;
+    for (size_t i = 0; i < ids_.size(); ++i) {
+      bool reduced = max_animated_regions > 0 && i >= max_animated_regions;
+      end = DrawElement(i, reduced, stream, end);
+    }
+    context->ostream().write(begin, end - begin);
+  }
+
+  if (!paused_) Step();
+  Compact();
+  if (!repeat_ && ids_.empty()) ended_ = true;
+}
+
+void AnimationPool::UpdateEscapes(const Stream& stream) {
+  int support = GetColorSupport(stream.console_info());
+  if (support == escape_support_ && escapes_.size() == colors_.size()) return;
+  if (support != escape_support_) escapes_.clear();
+  escape_support_ = support;
+  for (size_t i = escapes_.size(); i < colors_.size(); ++i) {
+    escapes_.push_back(stream.GetRgbEscape(colors_[i], &escape_kind_));
+  }
+  // The 16 colors all take as many bytes, so the dithered ones are bounded
+  // too.
+  max_escape_length_ = 0;
+  for (const std::string& escape : escapes_) {
+    max_escape_length_ = std::max(max_escape_length_, escape.length());
+  }
+  const Console::Info& info = stream.console_info();
+  dither_ = !info.support_truecolor && !info.support_8bit_color &&
+            info.support_4bit_color;
+}
+
+char* AnimationPool::DrawElement(size_t index, bool reduced,
+                                 const Stream& stream, char* out) const {
+  size_t length = text_lengths_[index];
+  if (length == 0) return out;
+  absl::string_view text(text_.data() + text_offsets_[index], length);
+  if (reduced) return AppendText(out, text);
+
+  size_t frame = frames_[index];
+  const Palette& palette = palettes_[palette_indices_[index]];
+  const std::string* escapes = escapes_.data() + palette.offset;
+  switch (effects_[index]) {
+    case Effect::kFlow: {
+      const color::Rgb* colors = colors_.data() + palette.offset;
+      size_t c = frame % palette.size;
+      for (size_t i = 0; i < length; ++i) {
+        if (dither_) {
+          EscapeKind kind;
+          out = AppendEscape(out, EscapeKind::kColor4,
+                             stream.GetRgbEscape(colors[c], i, 0, &kind));
+        } else {
+          out = AppendEscape(out, escape_kind_, escapes[c]);
+        }
+        out = AppendText(out, text.substr(i, 1));
+        if (++c == palette.size) c = 0;
+      }
+      out = AppendEscape(out, EscapeKind::kSgr, kColorOff);
+      break;
+    }
+    case Effect::kNeon:
+      out = AppendEscape(out, escape_kind_, escapes[frame % palette.size]);
+      out = AppendText(out, text);
+      out = AppendEscape(out, EscapeKind::kSgr, kColorOff);
+      break;
+    case Effect::kKaraoke: {
+      size_t i = frame % length;
+      if (i > 0) {
+        out = AppendEscape(out, escape_kind_, escapes[0]);
+        out = AppendText(out, text.substr(0, i));
+        out = AppendEscape(out, EscapeKind::kSgr, kColorOff);
+      }
+      out = AppendText(out, text.substr(i));
+      break;
+    }
+    case Effect::kRadar: {
+      size_t offset = frame % length;
+      size_t window_end = std::min(length, offset + palette.size);
+      if (offset > 0) {
+        out = AppendEscape(out, EscapeKind::kSgr, kConceal);
+        out = AppendText(out, text.substr(0, offset));
+        out = AppendEscape(out, EscapeKind::kSgr, kConcealOff);
+      }
+      for (size_t i = offset; i < window_end; ++i) {
+        out = AppendEscape(out, escape_kind_, escapes[i - offset]);
+        out = AppendText(out, text.substr(i, 1));
+      }
+      out = AppendEscape(out, EscapeKind::kSgr, kColorOff);
+      if (window_end < length) {
+        out = AppendEscape(out, EscapeKind::kSgr, kConceal);
+        out = AppendText(out, text.substr(window_end));
+        out = AppendEscape(out, EscapeKind::kSgr, kConcealOff);
+      }
+      break;
+    }
+  }
+  return out;
+}
+
+void AnimationPool::Compact() {
+  if (inactive_count_ == 0) return;
+
+  std::string text;
+  text.reserve(text_.size());
+  size_t j = 0;
+  for (size_t i = 0; i < ids_.size(); ++i) {
+    if (flags_[i] & (kEnded | kRemoved)) {
+      indices_[ids_[i]] = kDropped;
+      continue;
+    }
+    uint32_t offset = text_offsets_[i];
+    text_offsets_[j] = static_cast<uint32_t>(text.size());
+    text.append(text_, offset, text_lengths_[i]);
+    text_lengths_[j] = text_lengths_[i];
+    frames_[j] = frames_[i];
+    end_frames_[j] = end_frames_[i];
+    palette_indices_[j] = palette_indices_[i];
+    effects_[j] = effects_[i];
+    flags_[j] = flags_[i];
+    ids_[j] = ids_[i];
+    indices_[ids_[j]] = static_cast<uint32_t>(j);
+    j++;
+  }
+  text_.swap(text);
+  text_offsets_.resize(j);
+  text_lengths_.resize(j);
+  frames_.resize(j);
+  end_frames_.resize(j);
+  palette_indices_.resize(j);
+  effects_.resize(j);
+  flags_.resize(j);
+  ids_.resize(j);
+  inactive_count_ = 0;
+}
+
+}  // namespace console
@@ -0,0 +1,129 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/animation_pool.h"
+
+#include <string.h>
+
+#include "color/named_color.h"
+#include "gtest/gtest.h"
+
+namespace console {
+
+namespace {
+
+const char kText[] = "Hello World";
+
+// Expects an element of |effect| to draw the same as |animation|.
+void ExpectSameAsAnimation(AnimationPool::Effect effect,
+                           const std::vector<color::Rgb>& colors,
+                           TextAnimation* animation) {
+  AnimationPool pool;
+  pool.set_repeat(true);
+  pool.Add(effect, kText, pool.AddPalette(colors), true);
+  animation->set_text(kText);
+  animation->set_repeat(true);
+
+  BufferRenderTarget pool_target;
+  RenderContext pool_context(&pool_target);
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  for (size_t i = 0; i < 2 * strlen(kText); ++i) {
+    pool.Update(&pool_context);
+    animation->Update(&context);
+    EXPECT_EQ(pool_target.buffer(), target.buffer()) << "frame " << i;
+    pool_target.Clear();
+    target.Clear();
+  }
+}
+
+}  // namespace
+
+TEST(AnimationPoolTest, SameAsAnimations) {
+  std::vector<color::Rgb> colors = {color::kBlack, color::kGray,
+                                    color::kWhite};
+  {
+    FlowTextAnimation animation;
+    animation.set_colors(colors);
+    ExpectSameAsAnimation(AnimationPool::Effect::kFlow, colors, &animation);
+  }
+  {
+    NeonTextAnimation animation;
+    animation.set_colors(colors);
+    ExpectSameAsAnimation(AnimationPool::Effect::kNeon, colors, &animation);
+  }
+  {
+    KaraokeTextAnimation animation;
+    animation.set_color(color::kBlack);
+    ExpectSameAsAnimation(AnimationPool::Effect::kKaraoke, colors,
+                          &animation);
+  }
+  {
+    RadarTextAnimation animation;
+    animation.set_colors(colors);
+    ExpectSameAsAnimation(AnimationPool::Effect::kRadar, colors, &animation);
+  }
+}
+
+TEST(AnimationPoolTest, EndAndRemove) {
+  AnimationPool pool;
+  bool ended = false;
+  pool.set_on_animation_end([&ended]() { ended = true; });
+  uint32_t palette = pool.AddPalette({color::kRed, color::kBlue});
+  AnimationPool::ElementId neon =
+      pool.Add(AnimationPool::Effect::kNeon, "neon", palette);
+  AnimationPool::ElementId karaoke =
+      pool.Add(AnimationPool::Effect::kKaraoke, "karaoke", palette);
+  AnimationPool::ElementId repeat =
+      pool.Add(AnimationPool::Effect::kFlow, "repeat", palette, true);
+  EXPECT_EQ(pool.size(), 3u);
+
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  // The neon element ends after a frame per color.
+  pool.Update(&context);
+  pool.Update(&context);
+  EXPECT_EQ(pool.size(), 2u);
+  // Removing an element which ended does nothing.
+  pool.Remove(neon);
+  EXPECT_EQ(pool.size(), 2u);
+
+  pool.Remove(repeat);
+  EXPECT_EQ(pool.size(), 1u);
+  target.Clear();
+  pool.Update(&context);
+  EXPECT_EQ(target.buffer().find("repeat"), std::string::npos);
+  EXPECT_FALSE(ended);
+
+  // The karaoke element ends after a frame per character.
+  for (int i = 3; i < 7; ++i) pool.Update(&context);
+  EXPECT_EQ(pool.size(), 0u);
+  EXPECT_TRUE(ended);
+  pool.Remove(karaoke);
+}
+
+TEST(AnimationPoolTest, Advance) {
+  AnimationPool pool;
+  uint32_t palette = pool.AddPalette({color::kRed});
+  pool.Add(AnimationPool::Effect::kKaraoke, "first", palette);
+
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  pool.Update(&context);
+  pool.Update(&context);
+  pool.Add(AnimationPool::Effect::kKaraoke, "second", palette);
+  // Each element moves ahead of its own frame: the first one reaches its
+  // end, the second one doesn't.
+  pool.Advance(3);
+  EXPECT_EQ(pool.current_frame(), 5u);
+  EXPECT_EQ(pool.size(), 1u);
+  target.Clear();
+  pool.Update(&context);
+  EXPECT_EQ(target.buffer().find("first"), std::string::npos);
+  // The second element draws its 4th frame.
+  EXPECT_NE(target.buffer().find(std::string(kColorOff) + "ond"),
+            std::string::npos);
+}
+
+}  // namespace console
@@ -0,0 +1,124 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/animation_scheduler.h"
+
+#include "console/adaptive_quality.h"
+#include "console/metrics.h"
+#include "console/tracing.h"
+
+namespace console {
+
+AnimationScheduler::AnimationScheduler(std::ostream& ostream)
+    : owned_target_(new OstreamRenderTarget(ostream)),
+      context_(owned_target_.get()) {}
+
+AnimationScheduler::AnimationScheduler(RenderTarget* target)
+    : context_(target) {}
+
+AnimationScheduler::~AnimationScheduler() = default;
+
+void AnimationScheduler::AddAnimation(std::unique_ptr<Animation> animation,
+                                      std::chrono::milliseconds interval) {
+  size_t index;
+  if (free_entries_.empty()) {
+    index = entries_.size();
+    entries_.emplace_back();
+  } else {
+    index = free_entries_.back();
+    free_entries_.pop_back();
+  }
+  entries_[index].animation = std::move(animation);
+  entries_[index].interval = interval;
+  // Clock::time_point::min() marks that the first frame is not yet rendered.
+  deadlines_.push({Clock::time_point::min(), animations_added_++, index});
+}
+
+AnimationScheduler::Clock::time_point AnimationScheduler::Tick(
+    Clock::time_point now) {
+  CONSOLE_TRACE_EVENT("AnimationScheduler::Tick");
+  bool updated = false;
+  std::vector<Deadline> next_deadlines;
+  while (!deadlines_.empty() && deadlines_.top().time <= now) {
+    Deadline deadline = deadlines_.top();
+    deadlines_.pop();
+
+    Entry& entry = entries_[deadline.index];
+    entry.animation->Update(&context_);
+    updated = true;
+    if (entry.animation->ended_) {
+      entry.animation.reset();
+      free_entries_.push_back(deadline.index);
+      continue;
+    }
+
+    std::chrono::milliseconds interval = GetInterval(entry);
+    if (deadline.time == Clock::time_point::min()) {
+      deadline.time = now + interval;
+    } else {
+      deadline.time += interval;
+      if (deadline.time <= now && interval.count() > 0) {
+        size_t skipped = (now - deadline.time) / interval + 1;
+        deadline.time += interval * skipped;
+        frames_skipped_ += skipped;
+        if (catch_up_) {
+          entry.animation->Advance(skipped);
+        }
+        CONSOLE_METRICS(Metrics::RecordFrameSkipped(skipped));
+      }
+    }
+    // Pushed after the loop, otherwise an interval of 0 never ends the tick.
+    next_deadlines.push_back(deadline);
+  }
+  for (const Deadline& deadline : next_deadlines) {
+    deadlines_.push(deadline);
+  }
+
+  if (updated) context_.Flush();
+
+  if (deadlines_.empty()) return Clock::time_point::max();
+  return deadlines_.top().time;
+}
+
+void AnimationScheduler::set_catch_up(bool catch_up) {
+  catch_up_ = catch_up;
+}
+
+void AnimationScheduler::set_tick_clock(const TickClock* tick_clock) {
+  context_.set_tick_clock(tick_clock);
+}
+
+void AnimationScheduler::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    lock.unlock();
+    Clock::time_point next = Tick(context_.tick_clock()->NowTicks());
+    lock.lock();
+    if (next == Clock::time_point::max()) break;
+    cv_.wait_until(lock, next, [this]() { return stopped_; });
+  }
+  stopped_ = false;
+}
+
+void AnimationScheduler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+}
+
+bool AnimationScheduler::empty() const { return deadlines_.empty(); }
+
+size_t AnimationScheduler::frames_skipped() const { return frames_skipped_; }
+
+std::chrono::milliseconds AnimationScheduler::GetInterval(
+    const Entry& entry) const {
+  AdaptiveQualityController* controller =
+      AdaptiveQualityController::GetCurrent();
+  if (controller) return controller->frame_interval(entry.interval);
+  return entry.interval;
+}
+
+}  // namespace console
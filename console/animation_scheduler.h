@@ -0,0 +1,125 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_ANIMATION_SCHEDULER_H_
+#define CONSOLE_ANIMATION_SCHEDULER_H_
+
+#include <stddef.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "console/animation.h"
+#include "console/export.h"
+#include "console/render_context.h"
+#include "console/render_target.h"
+#include "console/tick_clock.h"
+
+namespace console {
+
+// AnimationScheduler owns animations and updates each of them at its own
+// interval. Deadlines are kept in a min heap over a monotonic clock, so that
+// Run() sleeps exactly until the next frame is due instead of polling.
+// All the animations due in the same tick are drawn with the same
+// RenderContext and flushed once. If the scheduler falls behind, the missed
+// frames are skipped rather than rendered late, and with set_catch_up(), the
+// animations jump past them to stay on time.
+//
+// If an AdaptiveQualityController is installed, the intervals are scaled by
+// its current quality.
+class CONSOLE_EXPORT AnimationScheduler {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  explicit AnimationScheduler(std::ostream& ostream = std::cout);
+  // |target| must outlive the scheduler.
+  explicit AnimationScheduler(RenderTarget* target);
+  AnimationScheduler(const AnimationScheduler& other) = delete;
+  AnimationScheduler& operator=(const AnimationScheduler& other) = delete;
+  ~AnimationScheduler();
+
+  // Adds |animation| to be updated every |interval|. The first frame is due
+  // at the next tick.
+  void AddAnimation(std::unique_ptr<Animation> animation,
+                    std::chrono::milliseconds interval);
+
+  // Updates every animation whose deadline is at or before |now| and flushes
+  // once if any of them was updated. Ended animations are removed.
+  // Returns the deadline of the next frame, or Clock::time_point::max() if
+  // there is no animation left.
+  Clock::time_point Tick(Clock::time_point now);
+
+  // If |catch_up| is true, an animation which missed frames skips them with
+  // Animation::Advance(), so that it shows the frame due now, for example
+  // after the process was suspended. Groups and pools advance each of their
+  // elements, so elements at different frames stay apart. Otherwise, it
+  // continues from where it stopped. The default is false.
+  void set_catch_up(bool catch_up);
+
+  // Sets the clock Run() reads and the animations are drawn with. The default
+  // is DefaultTickClock. |tick_clock| must outlive the scheduler.
+  void set_tick_clock(const TickClock* tick_clock);
+
+  // Ticks and sleeps until every animation ends or Stop() is called. It
+  // sleeps in real time, so with a VirtualTickClock, call Tick() instead or
+  // use HeadlessRunner.
+  void Run();
+  // Makes Run() return. It is safe to call from any thread.
+  void Stop();
+
+  bool empty() const;
+  // Returns the number of frames skipped since the scheduler fell behind.
+  size_t frames_skipped() const;
+
+ private:
+  friend class AnimationSchedulerTestPeer;
+
+  struct Entry {
+    std::unique_ptr<Animation> animation;
+    std::chrono::milliseconds interval;
+  };
+
+  struct Deadline {
+    Clock::time_point time;
+    // The number of animations added before this one.
+    size_t order;
+    // The index in |entries_|.
+    size_t index;
+
+    // Makes std::priority_queue a min heap. Ties are broken by |order| so that
+    // animations due in the same tick are updated in the order added, even
+    // if a later one reuses an earlier slot.
+    bool operator<(const Deadline& other) const {
+      if (time != other.time) return time > other.time;
+      return order > other.order;
+    }
+  };
+
+  std::chrono::milliseconds GetInterval(const Entry& entry) const;
+
+  // Set if the scheduler was given a std::ostream.
+  std::unique_ptr<RenderTarget> owned_target_;
+  RenderContext context_;
+  std::vector<Entry> entries_;
+  // The indexes of the |entries_| whose animation ended, reused by
+  // AddAnimation() so that |entries_| doesn't grow with every animation.
+  std::vector<size_t> free_entries_;
+  size_t animations_added_ = 0;
+  std::priority_queue<Deadline> deadlines_;
+  size_t frames_skipped_ = 0;
+  bool catch_up_ = false;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopped_ = false;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_ANIMATION_SCHEDULER_H_
@@ -0,0 +1,181 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/animation_scheduler.h"
+
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace console {
+
+class AnimationSchedulerTestPeer {
+ public:
+  static size_t entry_count(const AnimationScheduler& scheduler) {
+    return scheduler.entries_.size();
+  }
+};
+
+namespace {
+
+class CountingAnimation : public Animation {
+ public:
+  CountingAnimation(size_t* count, size_t total_frames = 0)
+      : count_(count), total_frames_(total_frames) {}
+
+ private:
+  bool ShouldUpdate() override { return true; }
+
+  void DoUpdate(RenderContext* context) override {
+    (*count_)++;
+    if (total_frames_ > 0 && current_frame_ + 1 == total_frames_) {
+      ended_ = true;
+    }
+  }
+
+  size_t* count_;
+  size_t total_frames_;
+};
+
+// Appends |id| to |log| on every update and ends after a frame.
+class LoggingAnimation : public Animation {
+ public:
+  LoggingAnimation(std::vector<int>* log, int id) : log_(log), id_(id) {}
+
+ private:
+  bool ShouldUpdate() override { return true; }
+
+  void DoUpdate(RenderContext* context) override {
+    log_->push_back(id_);
+    ended_ = true;
+  }
+
+  std::vector<int>* log_;
+  int id_;
+};
+
+}  // namespace
+
+TEST(AnimationSchedulerTest, PerAnimationInterval) {
+  std::stringstream ss;
+  AnimationScheduler scheduler(ss);
+  size_t fast = 0;
+  size_t slow = 0;
+  scheduler.AddAnimation(
+      std::unique_ptr<Animation>(new CountingAnimation(&fast)),
+      std::chrono::milliseconds(10));
+  scheduler.AddAnimation(
+      std::unique_ptr<Animation>(new CountingAnimation(&slow)),
+      std::chrono::milliseconds(30));
+
+  AnimationScheduler::Clock::time_point now;
+  EXPECT_EQ(scheduler.Tick(now), now + std::chrono::milliseconds(10));
+  EXPECT_EQ(fast, 1);
+  EXPECT_EQ(slow, 1);
+  for (int i = 1; i <= 6; ++i) {
+    scheduler.Tick(now + std::chrono::milliseconds(10 * i));
+  }
+  EXPECT_EQ(fast, 7);
+  EXPECT_EQ(slow, 3);
+  EXPECT_EQ(scheduler.frames_skipped(), 0);
+}
+
+TEST(AnimationSchedulerTest, SkipFrames) {
+  std::stringstream ss;
+  AnimationScheduler scheduler(ss);
+  size_t count = 0;
+  scheduler.AddAnimation(
+      std::unique_ptr<Animation>(new CountingAnimation(&count)),
+      std::chrono::milliseconds(10));
+
+  AnimationScheduler::Clock::time_point now;
+  scheduler.Tick(now);
+  // Falls behind by 4 frames.
+  EXPECT_EQ(scheduler.Tick(now + std::chrono::milliseconds(55)),
+            now + std::chrono::milliseconds(60));
+  EXPECT_EQ(count, 2);
+  EXPECT_EQ(scheduler.frames_skipped(), 4);
+}
+
+TEST(AnimationSchedulerTest, CatchUp) {
+  std::stringstream ss;
+  AnimationScheduler scheduler(ss);
+  scheduler.set_catch_up(true);
+  size_t count = 0;
+  std::unique_ptr<Animation> animation(new CountingAnimation(&count));
+  Animation* counting = animation.get();
+  scheduler.AddAnimation(std::move(animation), std::chrono::milliseconds(10));
+
+  AnimationScheduler::Clock::time_point now;
+  scheduler.Tick(now);
+  scheduler.Tick(now + std::chrono::milliseconds(55));
+  EXPECT_EQ(count, 2);
+  // The frame due at 60ms is the 7th.
+  EXPECT_EQ(counting->current_frame(), 6);
+}
+
+TEST(AnimationSchedulerTest, CatchUpGroup) {
+  std::stringstream ss;
+  AnimationScheduler scheduler(ss);
+  scheduler.set_catch_up(true);
+  size_t count = 0;
+  std::unique_ptr<AnimationGroup> group(new AnimationGroup());
+  group->AddAnimation(
+      std::unique_ptr<Animation>(new CountingAnimation(&count)));
+  AnimationGroup* group_ptr = group.get();
+  scheduler.AddAnimation(std::move(group), std::chrono::milliseconds(10));
+
+  AnimationScheduler::Clock::time_point now;
+  for (int i = 0; i < 100; ++i) {
+    scheduler.Tick(now + std::chrono::milliseconds(10 * i));
+  }
+  std::unique_ptr<KaraokeTextAnimation> karaoke(new KaraokeTextAnimation());
+  karaoke->set_text("Hello World");
+  KaraokeTextAnimation* karaoke_ptr = karaoke.get();
+  group_ptr->AddAnimation(std::move(karaoke));
+  scheduler.Tick(now + std::chrono::milliseconds(1000));
+  // Falls behind by 2 frames. The child added late skips 2 of its own
+  // frames, instead of jumping to the frame of the group and ending.
+  scheduler.Tick(now + std::chrono::milliseconds(1030));
+  EXPECT_EQ(group_ptr->current_frame(), 104u);
+  EXPECT_EQ(karaoke_ptr->current_frame(), 4u);
+  EXPECT_EQ(group_ptr->size(), 2u);
+}
+
+TEST(AnimationSchedulerTest, RemoveEndedAnimations) {
+  std::stringstream ss;
+  AnimationScheduler scheduler(ss);
+  size_t count = 0;
+  scheduler.AddAnimation(
+      std::unique_ptr<Animation>(new CountingAnimation(&count, 3)),
+      std::chrono::milliseconds(0));
+
+  scheduler.Run();
+  EXPECT_EQ(count, 3);
+  EXPECT_TRUE(scheduler.empty());
+}
+
+TEST(AnimationSchedulerTest, ReuseEndedEntries) {
+  std::stringstream ss;
+  AnimationScheduler scheduler(ss);
+  std::vector<int> log;
+  AnimationScheduler::Clock::time_point now;
+  for (int i = 0; i < 10; ++i) {
+    scheduler.AddAnimation(
+        std::unique_ptr<Animation>(new LoggingAnimation(&log, 2 * i)),
+        std::chrono::milliseconds(10));
+    scheduler.AddAnimation(
+        std::unique_ptr<Animation>(new LoggingAnimation(&log, 2 * i + 1)),
+        std::chrono::milliseconds(10));
+    scheduler.Tick(now);
+  }
+  EXPECT_TRUE(scheduler.empty());
+  EXPECT_EQ(AnimationSchedulerTestPeer::entry_count(scheduler), 2u);
+  // Animations in reused entries are still updated in the order added.
+  ASSERT_EQ(log.size(), 20u);
+  for (int i = 0; i < 20; ++i) EXPECT_EQ(log[i], i);
+}
+
+}  // namespace console
@@ -4,7 +4,10 @@
 
 #include "console/animation.h"
 
+#include <ctype.h>
+
 #include "color/named_color.h"
+#include "console/thread_pool.h"
 #include "gtest/gtest.h"
 
 namespace console {
@@ -29,7 +32,7 @@ class TestAnimation : public TextAnimation {
     return should_update_callback_();
   }
 
-  void DoUpdate() override {
+  void DoUpdate(RenderContext* context) override {
     if (do_update_callback_) do_update_callback_();
   }
 
@@ -40,6 +43,160 @@ class TestAnimation : public TextAnimation {
   DoUpdateCallback do_update_callback_;
 };
 
+class FiniteAnimation : public Animation {
+ public:
+  FiniteAnimation(size_t total_frames, size_t* destroyed)
+      : total_frames_(total_frames), destroyed_(destroyed) {}
+  ~FiniteAnimation() override { (*destroyed_)++; }
+
+ private:
+  bool ShouldUpdate() override { return true; }
+
+  void DoUpdate(RenderContext* context) override {
+    if (current_frame_ + 1 == total_frames_) ended_ = true;
+  }
+
+  size_t total_frames_;
+  size_t* destroyed_;
+};
+
+// Draws the text without attributes and counts the cells drawn.
+class PlainTextAnimation : public TextAnimation {
+ public:
+  size_t cells_drawn() const { return cells_drawn_; }
+
+ private:
+  bool ShouldUpdate() override { return true; }
+
+  void DoUpdate(RenderContext* context) override {
+    DrawFrame(context);
+  }
+
+  void DrawCells(Stream* stream, size_t begin, size_t end) override {
+    cells_drawn_ += end - begin;
+    TextAnimation::DrawCells(stream, begin, end);
+  }
+
+  size_t cells_drawn_ = 0;
+};
+
+// Removes the escape sequences from |output|.
+std::string StripEscapes(const std::string& output) {
+  std::string text;
+  for (size_t i = 0; i < output.length(); ++i) {
+    if (output[i] != '\e') {
+      text.push_back(output[i]);
+      continue;
+    }
+    // Skips up to the final byte of the sequence.
+    for (i += 2; i < output.length() && !isalpha(output[i]); ++i) {
+    }
+  }
+  return text;
+}
+
+// Applies the output of a text animation on a single line, to compare what
+// ends up on screen.
+class LineEmulator {
+ public:
+  struct Cell {
+    char c = ' ';
+    bool concealed = false;
+    std::string color;
+
+    bool operator==(const Cell& other) const {
+      return c == other.c && concealed == other.concealed &&
+             color == other.color;
+    }
+  };
+
+  void Apply(const std::string& output) {
+    for (size_t i = 0; i < output.length(); ++i) {
+      if (output[i] != '\e') {
+        if (cursor_ >= cells_.size()) cells_.resize(cursor_ + 1);
+        cells_[cursor_].c = output[i];
+        cells_[cursor_].concealed = concealed_;
+        cells_[cursor_].color = color_;
+        cursor_++;
+        continue;
+      }
+      // Skips '\e['.
+      i += 2;
+      size_t begin = i;
+      while (!isalpha(output[i])) i++;
+      std::string params = output.substr(begin, i - begin);
+      switch (output[i]) {
+        case 'm':
+          ApplySgr(params);
+          break;
+        case 'C':
+          cursor_ += std::stoul(params);
+          break;
+        case 'D':
+          cursor_ -= std::stoul(params);
+          break;
+        case 'K':
+          if (cursor_ < cells_.size()) cells_.resize(cursor_);
+          break;
+      }
+    }
+  }
+
+  void set_cursor(size_t cursor) { cursor_ = cursor; }
+
+  const std::vector<Cell>& cells() const { return cells_; }
+
+ private:
+  void ApplySgr(const std::string& params) {
+    if (params == "0") {
+      concealed_ = false;
+      color_.clear();
+    } else if (params == "8") {
+      concealed_ = true;
+    } else if (params == "28") {
+      concealed_ = false;
+    } else if (params == "39") {
+      color_.clear();
+    } else {
+      color_ = params;
+    }
+  }
+
+  std::vector<Cell> cells_;
+  size_t cursor_ = 0;
+  bool concealed_ = false;
+  std::string color_;
+};
+
+void ExpectSameAsFullRendering(TextAnimation* delta_animation,
+                               TextAnimation* animation) {
+  delta_animation->set_delta_rendering(true);
+  BufferRenderTarget delta_target;
+  RenderContext delta_context(&delta_target);
+  LineEmulator delta_line;
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  LineEmulator line;
+
+  size_t length = animation->text().length();
+  size_t delta_bytes = 0;
+  size_t bytes = 0;
+  for (size_t i = 0; i < 2 * length + 3; ++i) {
+    delta_animation->Update(&delta_context);
+    delta_line.Apply(delta_target.buffer());
+    animation->Update(&context);
+    line.set_cursor(0);
+    line.Apply(target.buffer());
+    EXPECT_TRUE(delta_line.cells() == line.cells()) << "frame " << i;
+
+    delta_bytes += delta_target.buffer().length();
+    bytes += target.buffer().length();
+    delta_target.Clear();
+    target.Clear();
+  }
+  EXPECT_LT(delta_bytes, bytes);
+}
+
 }  // namespace
 
 #define SETUP_CALLBACKS(animation)                                    \
@@ -182,6 +339,26 @@ TEST(NeonTextAnimationTest, Callback) {
   }
 }
 
+TEST(NeonTextAnimationTest, Timeline) {
+  ColorTimeline timeline;
+  timeline.AddKeyframe(0, color::kBlack);
+  timeline.AddKeyframe(5, color::kWhite);
+
+  NeonTextAnimation animation;
+  SETUP_CALLBACKS(animation);
+  animation.set_text("Hello World\n");
+  animation.set_timeline(timeline);
+  for (size_t i = 0; i < timeline.duration(); ++i) {
+    animation.Update();
+    EXPECT_TRUE(started);
+    if (i == timeline.duration() - 1) {
+      EXPECT_TRUE(ended);
+    } else {
+      EXPECT_FALSE(ended);
+    }
+  }
+}
+
 TEST(KaraokeTextAnimationTest, Callback) {
   {
     KaraokeTextAnimation animation;
@@ -274,4 +451,290 @@ TEST(RadarTextAnimationTest, Callback) {
   }
 }
 
-}  // namespace console
\ No newline at end of file
+TEST(AnimationGroupTest, UpdateInParallel) {
+  auto create_group = []() {
+    std::unique_ptr<AnimationGroup> group(new AnimationGroup());
+    for (size_t i = 0; i < 16; ++i) {
+      std::unique_ptr<FlowTextAnimation> animation(new FlowTextAnimation());
+      animation->set_text("Hello World " + std::to_string(i) + "\n");
+      animation->set_colors({color::kBlack, color::kGray, color::kWhite});
+      group->AddAnimation(std::move(animation));
+    }
+    return group;
+  };
+
+  BufferRenderTarget expected;
+  {
+    RenderContext context(&expected);
+    std::unique_ptr<AnimationGroup> group = create_group();
+    for (size_t i = 0; i < 5; ++i) group->Update(&context);
+  }
+
+  ThreadPool thread_pool(4);
+  BufferRenderTarget actual;
+  {
+    RenderContext context(&actual);
+    std::unique_ptr<AnimationGroup> group = create_group();
+    group->set_thread_pool(&thread_pool);
+    for (size_t i = 0; i < 5; ++i) group->Update(&context);
+  }
+
+  EXPECT_FALSE(expected.buffer().empty());
+  EXPECT_EQ(actual.buffer(), expected.buffer());
+}
+
+TEST(AnimationGroupTest, End) {
+  size_t destroyed = 0;
+  AnimationGroup group;
+  SETUP_CALLBACKS(group);
+  group.AddAnimation(
+      std::unique_ptr<Animation>(new FiniteAnimation(1, &destroyed)));
+  group.AddAnimation(
+      std::unique_ptr<Animation>(new FiniteAnimation(3, &destroyed)));
+  EXPECT_EQ(group.size(), 2);
+
+  group.Update();
+  EXPECT_EQ(group.size(), 1);
+  EXPECT_EQ(destroyed, 1);
+  EXPECT_FALSE(ended);
+  group.Update();
+  group.Update();
+  EXPECT_EQ(group.size(), 0);
+  EXPECT_EQ(destroyed, 2);
+  EXPECT_TRUE(ended);
+}
+
+TEST(AnimationGroupTest, AddAndRemove) {
+  size_t destroyed = 0;
+  AnimationGroup group;
+  SETUP_CALLBACKS(group);
+  group.set_repeat(true);
+  group.Update();
+  EXPECT_FALSE(started);
+
+  Animation* animation = new FiniteAnimation(100, &destroyed);
+  Animation* animation2 = new FiniteAnimation(100, &destroyed);
+  group.AddAnimation(std::unique_ptr<Animation>(animation));
+  group.AddAnimation(std::unique_ptr<Animation>(animation2));
+  group.Update();
+  EXPECT_TRUE(started);
+
+  group.RemoveAnimation(animation);
+  group.RemoveAnimation(animation);
+  EXPECT_EQ(group.size(), 1);
+  group.Update();
+  EXPECT_EQ(destroyed, 1);
+
+  group.AddAnimation(
+      std::unique_ptr<Animation>(new FiniteAnimation(1, &destroyed)));
+  EXPECT_EQ(group.size(), 2);
+  group.Update();
+  EXPECT_EQ(group.size(), 1);
+  EXPECT_EQ(destroyed, 2);
+
+  // A repeating group doesn't end even if it has no children.
+  group.RemoveAnimation(animation2);
+  group.Update();
+  EXPECT_EQ(group.size(), 0);
+  EXPECT_EQ(destroyed, 3);
+  EXPECT_FALSE(ended);
+}
+
+TEST(KaraokeTextAnimationTest, DeltaRendering) {
+  KaraokeTextAnimation animations[2];
+  for (auto& animation : animations) {
+    animation.set_text("Lorem ipsum dolor sit amet, consectetur adipiscing");
+    animation.set_color(color::kWhite);
+    animation.set_repeat(true);
+  }
+  ExpectSameAsFullRendering(&animations[0], &animations[1]);
+}
+
+TEST(RadarTextAnimationTest, DeltaRendering) {
+  RadarTextAnimation animations[2];
+  for (auto& animation : animations) {
+    animation.set_text("Lorem ipsum dolor sit amet, consectetur adipiscing");
+    animation.set_colors({color::kBlack, color::kGray, color::kWhite});
+    animation.set_repeat(true);
+  }
+  ExpectSameAsFullRendering(&animations[0], &animations[1]);
+}
+
+TEST(TextAnimationTest, DeltaRenderingWithFrameCache) {
+  FlowTextAnimation flow;
+  flow.set_colors({color::kBlack, color::kWhite});
+  NeonTextAnimation neon;
+  neon.set_colors({color::kBlack, color::kWhite});
+  TextAnimation* animations[] = {&flow, &neon};
+  for (TextAnimation* animation : animations) {
+    animation->set_text("abc");
+    animation->set_repeat(true);
+    animation->set_delta_rendering(true);
+    animation->EnableFrameCache();
+
+    BufferRenderTarget target;
+    RenderContext context(&target);
+    animation->Update(&context);
+    // No frame is replayed from the cache, which would miss the prefix.
+    for (int i = 1; i < 6; ++i) {
+      target.Clear();
+      animation->Update(&context);
+      EXPECT_EQ(target.buffer().find("\e[3D\e[K"), 0u) << "frame " << i;
+    }
+  }
+}
+
+TEST(TextAnimationTest, Viewport) {
+  std::string text;
+  for (int i = 0; i < 1000; ++i) text += "line " + std::to_string(i) + "\n";
+
+  PlainTextAnimation animation;
+  animation.set_text(text);
+  EXPECT_EQ(animation.GetLineCount(), 1000u);
+  TextAnimation::Viewport viewport;
+  viewport.row = 10;
+  viewport.column = 2;
+  viewport.rows = 3;
+  viewport.columns = 4;
+  animation.set_viewport(viewport);
+
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  animation.Update(&context);
+  EXPECT_EQ(StripEscapes(target.buffer()), "ne 1\nne 1\nne 1\n");
+  // Only the visible cells were drawn.
+  EXPECT_EQ(animation.cells_drawn(), 12u);
+
+  target.Clear();
+  animation.ScrollTo(998, 5);
+  animation.Update(&context);
+  EXPECT_EQ(StripEscapes(target.buffer()), "998\n999\n\n");
+
+  target.Clear();
+  animation.ClearViewport();
+  animation.Update(&context);
+  EXPECT_EQ(StripEscapes(target.buffer()), text);
+}
+
+namespace {
+
+// A terminal of 3 columns and 2 rows.
+class SizedRenderTarget : public BufferRenderTarget {
+ public:
+  bool GetWindowSize(size_t* columns, size_t* rows) override {
+    queries_++;
+    *columns = columns_;
+    *rows = rows_;
+    return true;
+  }
+
+  void Resize(size_t columns, size_t rows) {
+    columns_ = columns;
+    rows_ = rows;
+  }
+  size_t queries() const { return queries_; }
+
+ private:
+  size_t columns_ = 3;
+  size_t rows_ = 2;
+  size_t queries_ = 0;
+};
+
+}  // namespace
+
+TEST(TextAnimationTest, ViewportWindowSize) {
+  PlainTextAnimation animation;
+  animation.set_text("line 0\nline 1\nline 2\n");
+  animation.set_repeat(true);
+  animation.set_viewport(TextAnimation::Viewport());
+
+  SizedRenderTarget target;
+  RenderContext context(&target);
+  animation.Update(&context);
+  EXPECT_EQ(StripEscapes(target.buffer()), "lin\nlin\n");
+  // The size is asked once per frame, not once per line.
+  EXPECT_EQ(target.queries(), 1u);
+
+  target.Resize(5, 1);
+  target.Clear();
+  animation.Update(&context);
+  EXPECT_EQ(StripEscapes(target.buffer()), "line \n");
+  EXPECT_EQ(target.queries(), 2u);
+
+  // A resize drops the frames cached with the old size.
+  FlowTextAnimation flow;
+  flow.set_text("line 0\nline 1\n");
+  flow.set_colors({color::kWhite});
+  flow.set_repeat(true);
+  flow.set_viewport(TextAnimation::Viewport());
+  flow.EnableFrameCache();
+  flow.Update(&context);
+  target.Resize(3, 2);
+  target.Clear();
+  flow.Update(&context);
+  EXPECT_EQ(StripEscapes(target.buffer()), "lin\nlin\n");
+}
+
+TEST(AnimationTest, Seek) {
+  KaraokeTextAnimation animations[2];
+  for (auto& animation : animations) {
+    animation.set_text("Hello World");
+    animation.set_color(color::kWhite);
+  }
+  BufferRenderTarget targets[2];
+  RenderContext context0(&targets[0]);
+  RenderContext context1(&targets[1]);
+
+  for (int i = 0; i < 7; ++i) {
+    targets[0].Clear();
+    animations[0].Update(&context0);
+  }
+  animations[1].Seek(6);
+  EXPECT_EQ(animations[1].current_frame(), 6u);
+  animations[1].Update(&context1);
+  EXPECT_EQ(targets[0].buffer(), targets[1].buffer());
+
+  // Seeking past the last frame ends the animation at the next update.
+  bool ended = false;
+  animations[1].set_on_animation_end([&ended]() { ended = true; });
+  animations[1].SeekToTime(std::chrono::seconds(2),
+                           std::chrono::milliseconds(100));
+  EXPECT_EQ(animations[1].current_frame(), 20u);
+  animations[1].Update(&context1);
+  EXPECT_TRUE(ended);
+
+  // An ended animation runs again once it seeks.
+  animations[1].Seek(0);
+  targets[1].Clear();
+  animations[1].Update(&context1);
+  EXPECT_FALSE(targets[1].buffer().empty());
+}
+
+TEST(AnimationTest, Pause) {
+  std::unique_ptr<KaraokeTextAnimation> animation(new KaraokeTextAnimation());
+  KaraokeTextAnimation* karaoke = animation.get();
+  karaoke->set_text("Hello");
+  karaoke->set_color(color::kWhite);
+  AnimationGroup group;
+  SETUP_CALLBACKS(group);
+  group.AddAnimation(std::move(animation));
+  group.Pause();
+  EXPECT_TRUE(karaoke->paused());
+
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  karaoke->Seek(4);
+  for (int i = 0; i < 3; ++i) {
+    group.Update(&context);
+    EXPECT_EQ(karaoke->current_frame(), 4u);
+  }
+  EXPECT_EQ(did_update, 3);
+  // The child is on its last frame, but doesn't end while paused.
+  EXPECT_FALSE(ended);
+
+  group.Resume();
+  group.Update(&context);
+  EXPECT_TRUE(ended);
+}
+
+}  // namespace console
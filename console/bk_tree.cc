@@ -0,0 +1,94 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/bk_tree.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "console/edit_distance.h"
+
+namespace console {
+
+constexpr size_t BKTree::kNone;
+
+BKTree::BKTree() = default;
+
+BKTree::~BKTree() = default;
+
+bool BKTree::Insert(absl::string_view word) {
+  Node node;
+  node.word = word;
+  if (nodes_.empty()) {
+    node.distance = 0;
+    nodes_.push_back(node);
+    return true;
+  }
+
+  size_t parent = 0;
+  EditDistanceMatcher matcher(word);
+  while (true) {
+    size_t distance = matcher.Distance(nodes_[parent].word);
+    if (distance == 0) return false;
+    size_t child = nodes_[parent].first_child;
+    while (child != kNone && nodes_[child].distance != distance) {
+      child = nodes_[child].next_sibling;
+    }
+    if (child == kNone) {
+      node.distance = distance;
+      node.next_sibling = nodes_[parent].first_child;
+      nodes_[parent].first_child = nodes_.size();
+      nodes_[parent].max_child_distance =
+          std::max(nodes_[parent].max_child_distance, distance);
+      nodes_.push_back(node);
+      return true;
+    }
+    parent = child;
+  }
+}
+
+std::vector<BKTree::Match> BKTree::Find(absl::string_view word,
+                                        size_t max_distance) const {
+  if (nodes_.empty()) return {};
+  // The distances and indices of the matches.
+  std::vector<std::pair<size_t, size_t>> found;
+
+  EditDistanceMatcher matcher(word);
+  std::vector<size_t> pending = {0};
+  while (!pending.empty()) {
+    size_t index = pending.back();
+    pending.pop_back();
+    const Node& node = nodes_[index];
+
+    // Farther than this, neither the node nor any of its children matches,
+    // so the exact distance isn't needed.
+    size_t limit = max_distance + node.max_child_distance;
+    size_t distance = matcher.Distance(node.word, limit);
+    if (distance <= max_distance) found.emplace_back(distance, index);
+    if (distance > limit) continue;
+
+    for (size_t child = node.first_child; child != kNone;
+         child = nodes_[child].next_sibling) {
+      size_t child_distance = nodes_[child].distance;
+      if (child_distance + max_distance >= distance &&
+          child_distance <= distance + max_distance) {
+        pending.push_back(child);
+      }
+    }
+  }
+
+  std::sort(found.begin(), found.end());
+  std::vector<Match> matches;
+  matches.reserve(found.size());
+  for (const auto& match : found) {
+    matches.push_back({nodes_[match.second].word, match.first});
+  }
+  return matches;
+}
+
+size_t BKTree::size() const { return nodes_.size(); }
+
+bool BKTree::empty() const { return nodes_.empty(); }
+
+}  // namespace console
@@ -0,0 +1,67 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_BK_TREE_H_
+#define CONSOLE_BK_TREE_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "console/export.h"
+
+namespace console {
+
+// BKTree (Burkhard-Keller tree) indexes words by their edit distance, to find
+// the words close to a query without measuring the distance to all of them.
+// Each child is keyed by its distance to its parent, and by the triangle
+// inequality only the children whose key is within |max_distance| of the
+// distance from the query to the parent can hold a match.
+//
+// BKTree tree;
+// tree.Insert("--verbose");
+// tree.Insert("--version");
+// tree.Find("--verbos", 1);  // {"--verbose", 1}
+class CONSOLE_EXPORT BKTree {
+ public:
+  struct Match {
+    absl::string_view word;
+    size_t distance;
+  };
+
+  BKTree();
+  BKTree(const BKTree& other) = delete;
+  BKTree& operator=(const BKTree& other) = delete;
+  ~BKTree();
+
+  // |word| must outlive this. Returns false if it is already in the tree.
+  bool Insert(absl::string_view word);
+
+  // Returns the words within |max_distance| of |word|, the closest first and
+  // in the order they were inserted among the equally close ones.
+  std::vector<Match> Find(absl::string_view word, size_t max_distance) const;
+
+  size_t size() const;
+  bool empty() const;
+
+ private:
+  static constexpr size_t kNone = static_cast<size_t>(-1);
+
+  struct Node {
+    absl::string_view word;
+    // The distance to the parent.
+    size_t distance;
+    size_t first_child = kNone;
+    size_t next_sibling = kNone;
+    size_t max_child_distance = 0;
+  };
+
+  // The nodes in the order they were inserted. The first is the root.
+  std::vector<Node> nodes_;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_BK_TREE_H_
@@ -0,0 +1,77 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/bk_tree.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "console/edit_distance.h"
+#include "gtest/gtest.h"
+
+namespace console {
+
+TEST(BKTreeTest, Find) {
+  BKTree tree;
+  EXPECT_TRUE(tree.Find("a", 1).empty());
+
+  EXPECT_TRUE(tree.Insert("--verbose"));
+  EXPECT_TRUE(tree.Insert("--version"));
+  EXPECT_TRUE(tree.Insert("--value"));
+  EXPECT_FALSE(tree.Insert("--verbose"));
+  EXPECT_EQ(tree.size(), 3u);
+
+  std::vector<BKTree::Match> matches = tree.Find("--verbos", 1);
+  ASSERT_EQ(matches.size(), 1u);
+  EXPECT_EQ(matches[0].word, "--verbose");
+  EXPECT_EQ(matches[0].distance, 1u);
+
+  matches = tree.Find("--versio", 4);
+  ASSERT_EQ(matches.size(), 2u);
+  EXPECT_EQ(matches[0].word, "--version");
+  EXPECT_EQ(matches[0].distance, 1u);
+  EXPECT_EQ(matches[1].word, "--verbose");
+  EXPECT_EQ(matches[1].distance, 4u);
+}
+
+TEST(BKTreeTest, SameAsLinearSearch) {
+  std::mt19937 random(7);
+  std::uniform_int_distribution<size_t> length(1, 8);
+  std::uniform_int_distribution<int> c('a', 'e');
+  std::vector<std::string> words(500);
+  for (std::string& word : words) {
+    word.resize(length(random));
+    for (char& ch : word) ch = static_cast<char>(c(random));
+  }
+
+  BKTree tree;
+  std::vector<absl::string_view> inserted;
+  for (const std::string& word : words) {
+    if (tree.Insert(word)) inserted.push_back(word);
+  }
+  ASSERT_EQ(tree.size(), inserted.size());
+
+  for (size_t i = 0; i < 50; ++i) {
+    const std::string& query = words[i];
+    for (size_t max_distance = 0; max_distance <= 3; ++max_distance) {
+      std::vector<BKTree::Match> expected;
+      for (size_t distance = 0; distance <= max_distance; ++distance) {
+        for (absl::string_view word : inserted) {
+          if (GetEditDistance(query, word) == distance) {
+            expected.push_back({word, distance});
+          }
+        }
+      }
+      std::vector<BKTree::Match> matches = tree.Find(query, max_distance);
+      ASSERT_EQ(matches.size(), expected.size());
+      for (size_t j = 0; j < matches.size(); ++j) {
+        EXPECT_EQ(matches[j].word, expected[j].word);
+        EXPECT_EQ(matches[j].distance, expected[j].distance);
+      }
+    }
+  }
+}
+
+}  // namespace console
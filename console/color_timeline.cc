@@ -0,0 +1,239 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/color_timeline.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+namespace console {
+
+namespace {
+
+// Oklab coordinates, linear RGB and easing progress are in fixed point with
+// |kFractionBits| bits of fraction. 14 bits keep every product of the
+// conversion below within 32 bits.
+constexpr int kFractionBits = 14;
+constexpr int32_t kOne = 1 << kFractionBits;
+
+// The easing curves are sampled at kEasingSteps + 1 points and linearly
+// interpolated in between.
+constexpr int kEasingStepBits = 8;
+constexpr int kEasingSteps = 1 << kEasingStepBits;
+
+// The sRGB transfer function is tabulated over the top 12 bits of a linear
+// channel.
+constexpr int kLinearTableBits = 12;
+
+int32_t ToFixed(double value) {
+  return static_cast<int32_t>(lround(value * kOne));
+}
+
+int32_t Multiply(int32_t a, int32_t b) { return (a * b) >> kFractionBits; }
+
+double ToLinear(uint8_t value) {
+  double c = value / 255.0;
+  return c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+}
+
+// Converts |rgb| to Oklab. This runs once per keyframe, so it is done in
+// floating point.
+void ToOklab(color::Rgb rgb, int32_t lab[3]) {
+  double r = ToLinear(rgb.data.r);
+  double g = ToLinear(rgb.data.g);
+  double b = ToLinear(rgb.data.b);
+
+  double l = cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+  double m = cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+  double s = cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+
+  lab[0] = ToFixed(0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s);
+  lab[1] = ToFixed(1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s);
+  lab[2] = ToFixed(0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s);
+}
+
+struct Tables {
+  Tables() {
+    for (int i = 0; i <= kEasingSteps; ++i) {
+      double t = static_cast<double>(i) / kEasingSteps;
+      double u = 1 - t;
+      ease_in[i] = ToFixed(t * t * t);
+      ease_out[i] = ToFixed(1 - u * u * u);
+      ease_in_out[i] = ToFixed(t < 0.5 ? 4 * t * t * t : 1 - 4 * u * u * u);
+    }
+    for (int i = 0; i < (1 << kLinearTableBits); ++i) {
+      double c = (i + 0.5) / (1 << kLinearTableBits);
+      c = c <= 0.0031308 ? 12.92 * c : 1.055 * pow(c, 1 / 2.4) - 0.055;
+      srgb[i] = static_cast<uint8_t>(std::min(255L, lround(c * 255)));
+    }
+    // The ends map exactly, so that black and white survive a round trip.
+    srgb[0] = 0;
+    srgb[(1 << kLinearTableBits) - 1] = 255;
+  }
+
+  int32_t ease_in[kEasingSteps + 1];
+  int32_t ease_out[kEasingSteps + 1];
+  int32_t ease_in_out[kEasingSteps + 1];
+  uint8_t srgb[1 << kLinearTableBits];
+};
+
+const Tables& GetTables() {
+  static const Tables* tables = new Tables();
+  return *tables;
+}
+
+// Maps the progress |t| in [0, kOne] through |easing|.
+int32_t Ease(ColorTimeline::Easing easing, int32_t t, const Tables& tables) {
+  const int32_t* table;
+  switch (easing) {
+    case ColorTimeline::Easing::kStep:
+      return t >= kOne ? kOne : 0;
+    case ColorTimeline::Easing::kLinear:
+      return t;
+    case ColorTimeline::Easing::kEaseIn:
+      table = tables.ease_in;
+      break;
+    case ColorTimeline::Easing::kEaseOut:
+      table = tables.ease_out;
+      break;
+    case ColorTimeline::Easing::kEaseInOut:
+      table = tables.ease_in_out;
+      break;
+  }
+  constexpr int kShift = kFractionBits - kEasingStepBits;
+  int32_t i = t >> kShift;
+  if (i >= kEasingSteps) return table[kEasingSteps];
+  int32_t fraction = t & ((1 << kShift) - 1);
+  return table[i] + (((table[i + 1] - table[i]) * fraction) >> kShift);
+}
+
+uint8_t ToSrgb(int32_t linear, const Tables& tables) {
+  linear = std::min(std::max(linear, 0), kOne - 1);
+  return tables.srgb[linear >> (kFractionBits - kLinearTableBits)];
+}
+
+// Converts |lab| in Oklab back to sRGB in fixed point.
+color::Rgb FromOklab(const int32_t lab[3], const Tables& tables) {
+  static const int32_t kLms[3][2] = {
+      {ToFixed(0.3963377774), ToFixed(0.2158037573)},
+      {ToFixed(-0.1055613458), ToFixed(-0.0638541728)},
+      {ToFixed(-0.0894841775), ToFixed(-1.2914855480)},
+  };
+  static const int32_t kRgb[3][3] = {
+      {ToFixed(4.0767416621), ToFixed(-3.3077115913), ToFixed(0.2309699292)},
+      {ToFixed(-1.2684380046), ToFixed(2.6097574011), ToFixed(-0.3413193965)},
+      {ToFixed(-0.0041960863), ToFixed(-0.7034186147), ToFixed(1.7076147010)},
+  };
+
+  int32_t lms[3];
+  for (int i = 0; i < 3; ++i) {
+    int32_t c = lab[0] + Multiply(kLms[i][0], lab[1]) +
+                Multiply(kLms[i][1], lab[2]);
+    lms[i] = Multiply(Multiply(c, c), c);
+  }
+  uint8_t rgb[3];
+  for (int i = 0; i < 3; ++i) {
+    int32_t c = Multiply(kRgb[i][0], lms[0]) + Multiply(kRgb[i][1], lms[1]) +
+                Multiply(kRgb[i][2], lms[2]);
+    rgb[i] = ToSrgb(c, tables);
+  }
+  return color::Rgb(rgb[0], rgb[1], rgb[2]);
+}
+
+}  // namespace
+
+ColorTimeline::ColorTimeline() = default;
+
+ColorTimeline::ColorTimeline(const ColorTimeline& other) = default;
+
+ColorTimeline& ColorTimeline::operator=(const ColorTimeline& other) = default;
+
+ColorTimeline::~ColorTimeline() = default;
+
+void ColorTimeline::AddKeyframe(uint32_t time, color::Rgb color,
+                                Easing easing) {
+  Keyframe keyframe;
+  keyframe.time = time;
+  keyframe.color = color;
+  keyframe.easing = easing;
+  ToOklab(color, keyframe.lab);
+  keyframe.inverse_span = 0;
+
+  auto it = std::lower_bound(
+      keyframes_.begin(), keyframes_.end(), time,
+      [](const Keyframe& keyframe, uint32_t time) {
+        return keyframe.time < time;
+      });
+  if (it != keyframes_.end() && it->time == time) {
+    *it = keyframe;
+  } else {
+    keyframes_.insert(it, keyframe);
+  }
+  UpdateSpans();
+}
+
+void ColorTimeline::Clear() { keyframes_.clear(); }
+
+bool ColorTimeline::empty() const { return keyframes_.empty(); }
+
+size_t ColorTimeline::size() const { return keyframes_.size(); }
+
+uint32_t ColorTimeline::duration() const {
+  return keyframes_.empty() ? 0 : keyframes_.back().time;
+}
+
+color::Rgb ColorTimeline::Evaluate(uint32_t time) const {
+  color::Rgb color;
+  Evaluate(&time, 1, &color);
+  return color;
+}
+
+void ColorTimeline::Evaluate(const uint32_t* times, size_t n,
+                             color::Rgb* colors) const {
+  const Tables& tables = GetTables();
+  const Keyframe& first = keyframes_.front();
+  const Keyframe& last = keyframes_.back();
+  for (size_t i = 0; i < n; ++i) {
+    uint32_t time = times[i];
+    if (time <= first.time) {
+      colors[i] = first.color;
+      continue;
+    }
+    if (time >= last.time) {
+      colors[i] = last.color;
+      continue;
+    }
+
+    // There are only a few keyframes, so a linear search is the fastest.
+    size_t k = 0;
+    while (keyframes_[k + 1].time <= time) ++k;
+    const Keyframe& from = keyframes_[k];
+    const Keyframe& to = keyframes_[k + 1];
+
+    int32_t progress = static_cast<int32_t>(
+        ((time - from.time) * from.inverse_span) >> (40 - kFractionBits));
+    int32_t eased = Ease(from.easing, progress, tables);
+    if (eased == 0) {
+      colors[i] = from.color;
+      continue;
+    }
+
+    int32_t lab[3];
+    for (int j = 0; j < 3; ++j) {
+      lab[j] = from.lab[j] + Multiply(to.lab[j] - from.lab[j], eased);
+    }
+    colors[i] = FromOklab(lab, tables);
+  }
+}
+
+void ColorTimeline::UpdateSpans() {
+  for (size_t i = 0; i + 1 < keyframes_.size(); ++i) {
+    keyframes_[i].inverse_span =
+        (uint64_t{1} << 40) / (keyframes_[i + 1].time - keyframes_[i].time);
+  }
+  if (!keyframes_.empty()) keyframes_.back().inverse_span = 0;
+}
+
+}  // namespace console
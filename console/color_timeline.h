@@ -0,0 +1,88 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_COLOR_TIMELINE_H_
+#define CONSOLE_COLOR_TIMELINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "color/color.h"
+#include "console/export.h"
+
+namespace console {
+
+// ColorTimeline interpolates between colors at keyframes, so that a smooth
+// transition takes a few keyframes instead of a long vector of colors.
+//
+// Colors are interpolated in the Oklab color space, where equal steps look
+// equally large, so a transition doesn't pass through a muddy or overly
+// bright middle. Evaluating a color takes integer arithmetic and table
+// lookups only: keyframes are converted to Oklab in fixed point when they are
+// added and the easing curves are precomputed.
+//
+// ColorTimeline timeline;
+// timeline.AddKeyframe(0, color::kRed);
+// timeline.AddKeyframe(20, color::kBlue, ColorTimeline::Easing::kEaseInOut);
+// timeline.AddKeyframe(40, color::kRed);
+// flow_animation->set_timeline(timeline);
+class CONSOLE_EXPORT ColorTimeline {
+ public:
+  // How the color changes from a keyframe to the next one.
+  enum class Easing {
+    // Holds the color until the next keyframe.
+    kStep,
+    kLinear,
+    kEaseIn,
+    kEaseOut,
+    kEaseInOut,
+  };
+
+  ColorTimeline();
+  ColorTimeline(const ColorTimeline& other);
+  ColorTimeline& operator=(const ColorTimeline& other);
+  ~ColorTimeline();
+
+  // Adds a keyframe at |time|, replacing the one at the same time if any.
+  // |easing| applies from this keyframe to the next one. The unit of |time|
+  // is up to the user, for example a frame.
+  void AddKeyframe(uint32_t time, color::Rgb color,
+                   Easing easing = Easing::kLinear);
+  void Clear();
+
+  bool empty() const;
+  size_t size() const;
+  // Returns the time of the last keyframe.
+  uint32_t duration() const;
+
+  // Returns the color at |time|. Before the first keyframe, it is the color
+  // of the first keyframe and after the last one, the color of the last one.
+  // The timeline must not be empty.
+  color::Rgb Evaluate(uint32_t time) const;
+  // Evaluates |n| times at once, which is how animations color every cell of
+  // a frame.
+  void Evaluate(const uint32_t* times, size_t n, color::Rgb* colors) const;
+
+ private:
+  struct Keyframe {
+    uint32_t time;
+    color::Rgb color;
+    Easing easing;
+    // The color in Oklab, in fixed point.
+    int32_t lab[3];
+    // 2^40 / (time of the next keyframe - |time|), to turn a time into the
+    // progress in the segment without a division.
+    uint64_t inverse_span;
+  };
+
+  void UpdateSpans();
+
+  std::vector<Keyframe> keyframes_;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_COLOR_TIMELINE_H_
@@ -0,0 +1,102 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/color_timeline.h"
+
+#include <stdlib.h>
+
+#include "color/named_color.h"
+#include "gtest/gtest.h"
+
+namespace console {
+
+namespace {
+
+// The sRGB transfer function is steep near zero, so a dark channel moves by
+// a couple of levels even on a tiny step.
+void ExpectNear(color::Rgb expected, color::Rgb actual) {
+  EXPECT_LE(abs(expected.data.r - actual.data.r), 2);
+  EXPECT_LE(abs(expected.data.g - actual.data.g), 2);
+  EXPECT_LE(abs(expected.data.b - actual.data.b), 2);
+}
+
+}  // namespace
+
+TEST(ColorTimelineTest, Keyframes) {
+  ColorTimeline timeline;
+  EXPECT_TRUE(timeline.empty());
+  timeline.AddKeyframe(10, color::kRed);
+  timeline.AddKeyframe(0, color::kBlack);
+  timeline.AddKeyframe(20, color::kWhite);
+  timeline.AddKeyframe(10, color::kBlue);
+  EXPECT_EQ(timeline.size(), 3u);
+  EXPECT_EQ(timeline.duration(), 20u);
+
+  EXPECT_EQ(timeline.Evaluate(0), color::kBlack);
+  EXPECT_EQ(timeline.Evaluate(10), color::kBlue);
+  EXPECT_EQ(timeline.Evaluate(20), color::kWhite);
+  EXPECT_EQ(timeline.Evaluate(30), color::kWhite);
+}
+
+TEST(ColorTimelineTest, Interpolate) {
+  const color::Rgb kColors[] = {color::kBlack, color::kWhite, color::kRed,
+                                color::kBlue, color::kGray};
+  for (color::Rgb from : kColors) {
+    for (color::Rgb to : kColors) {
+      ColorTimeline timeline;
+      timeline.AddKeyframe(0, from);
+      timeline.AddKeyframe(1000, to);
+      ExpectNear(from, timeline.Evaluate(1));
+      ExpectNear(to, timeline.Evaluate(999));
+    }
+  }
+
+  // The middle of black and white in Oklab is L = 0.5, which is much darker
+  // than the middle in sRGB.
+  ColorTimeline timeline;
+  timeline.AddKeyframe(0, color::kBlack);
+  timeline.AddKeyframe(2, color::kWhite);
+  ExpectNear(color::Rgb(99, 99, 99), timeline.Evaluate(1));
+}
+
+TEST(ColorTimelineTest, Easing) {
+  ColorTimeline step;
+  step.AddKeyframe(0, color::kBlack, ColorTimeline::Easing::kStep);
+  step.AddKeyframe(10, color::kWhite);
+  EXPECT_EQ(step.Evaluate(9), color::kBlack);
+  EXPECT_EQ(step.Evaluate(10), color::kWhite);
+
+  ColorTimeline linear, ease_in, ease_out;
+  linear.AddKeyframe(0, color::kBlack);
+  ease_in.AddKeyframe(0, color::kBlack, ColorTimeline::Easing::kEaseIn);
+  ease_out.AddKeyframe(0, color::kBlack, ColorTimeline::Easing::kEaseOut);
+  for (ColorTimeline* timeline : {&linear, &ease_in, &ease_out}) {
+    timeline->AddKeyframe(100, color::kWhite);
+  }
+  uint8_t previous = 0;
+  for (uint32_t time = 0; time <= 100; time += 10) {
+    uint8_t value = ease_in.Evaluate(time).data.r;
+    EXPECT_GE(value, previous);
+    previous = value;
+  }
+  EXPECT_LT(ease_in.Evaluate(50).data.r, linear.Evaluate(50).data.r);
+  EXPECT_GT(ease_out.Evaluate(50).data.r, linear.Evaluate(50).data.r);
+}
+
+TEST(ColorTimelineTest, EvaluateMany) {
+  ColorTimeline timeline;
+  timeline.AddKeyframe(0, color::kRed, ColorTimeline::Easing::kEaseInOut);
+  timeline.AddKeyframe(7, color::kBlue);
+  timeline.AddKeyframe(13, color::kWhite);
+
+  std::vector<uint32_t> times;
+  for (uint32_t time = 0; time <= 15; ++time) times.push_back(time);
+  std::vector<color::Rgb> colors(times.size());
+  timeline.Evaluate(times.data(), times.size(), colors.data());
+  for (size_t i = 0; i < times.size(); ++i) {
+    EXPECT_EQ(colors[i], timeline.Evaluate(times[i]));
+  }
+}
+
+}  // namespace console
@@ -17,6 +17,7 @@
 #include <windows.h>
 #include <winver.h>
 #else
+#include <sys/ioctl.h>
 #include <unistd.h>
 #endif
 
@@ -157,10 +158,12 @@ Console::Info Console::GetInfo() {
   if (GetVersionInfo(&major_version, &minor_version, &buildnum)) {
     if (major_version >= 10 && buildnum >= 14931) {
       kConsoleInfo.support_ansi = true;
+      kConsoleInfo.support_4bit_color = true;
       kConsoleInfo.support_truecolor = true;
       return kConsoleInfo;
     } else if (major_version >= 10 && buildnum >= 10586) {
       kConsoleInfo.support_ansi = true;
+      kConsoleInfo.support_4bit_color = true;
       kConsoleInfo.support_8bit_color = true;
       return kConsoleInfo;
     }
@@ -187,6 +190,8 @@ Console::Info Console::GetInfo() {
                   [term_env](const char* prefix) {
                     return base::StartsWith(term_env, prefix);
                   });
+  // The 16 colors are part of the ANSI standard.
+  kConsoleInfo.support_4bit_color = kConsoleInfo.support_ansi;
 
   const char* colorterm_env = std::getenv("COLORTERM");
   if (colorterm_env) {
@@ -229,6 +234,26 @@ bool Console::IsConnected(std::ostream& os) {
   return false;
 }
 
+// static
+bool Console::GetWindowSize(std::ostream& os, size_t* columns, size_t* rows) {
+  if (!IsConnected(os)) return false;
+#if defined(OS_WIN)
+  CONSOLE_SCREEN_BUFFER_INFO info;
+  if (!GetConsoleScreenBufferInfo(GetConsoleHandle(os.rdbuf()), &info)) {
+    return false;
+  }
+  *columns = info.srWindow.Right - info.srWindow.Left + 1;
+  *rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+#else
+  int fd = os.rdbuf() == std::cout.rdbuf() ? fileno(stdout) : fileno(stderr);
+  winsize size;
+  if (ioctl(fd, TIOCGWINSZ, &size) != 0 || size.ws_col == 0) return false;
+  *columns = size.ws_col;
+  *rows = size.ws_row;
+#endif
+  return true;
+}
+
 #undef OS_WIN
 
 }  // namespace console
\ No newline at end of file
@@ -5,6 +5,8 @@
 #ifndef CONSOLE_CONSOLE_H_
 #define CONSOLE_CONSOLE_H_
 
+#include <stddef.h>
+
 #include <ostream>
 
 #include "console/export.h"
@@ -19,6 +21,7 @@ class CONSOLE_EXPORT Console {
  public:
   struct Info {
     bool support_ansi = false;
+    bool support_4bit_color = false;
     bool support_8bit_color = false;
     bool support_truecolor = false;
   };
@@ -28,6 +31,9 @@ class CONSOLE_EXPORT Console {
 #endif
   static Info GetInfo();
   static bool IsConnected(std::ostream& os);
+  // Sets the size of the terminal |os| is connected to, in cells. Returns
+  // false if it is not connected to a terminal.
+  static bool GetWindowSize(std::ostream& os, size_t* columns, size_t* rows);
 };
 
 }  // namespace console
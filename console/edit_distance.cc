@@ -0,0 +1,120 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/edit_distance.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace console {
+
+namespace {
+
+constexpr size_t kMaxBitParallelLength = 64;
+
+// Returns true if a distance of |distance| with |remaining| characters left
+// to read can't end up within |max_distance|, since each character lowers it
+// by at most 1.
+bool ExceedsMaxDistance(size_t distance, size_t remaining,
+                        size_t max_distance) {
+  return distance > remaining && distance - remaining > max_distance;
+}
+
+size_t CapDistance(size_t distance, size_t max_distance) {
+  return distance > max_distance ? max_distance + 1 : distance;
+}
+
+}  // namespace
+
+EditDistanceMatcher::EditDistanceMatcher(absl::string_view pattern)
+    : pattern_(pattern) {
+  memset(masks_, 0, sizeof(masks_));
+  if (pattern_.length() > kMaxBitParallelLength) return;
+  for (size_t i = 0; i < pattern_.length(); ++i) {
+    masks_[static_cast<uint8_t>(pattern_[i])] |= uint64_t{1} << i;
+  }
+}
+
+size_t EditDistanceMatcher::Distance(absl::string_view text,
+                                     size_t max_distance) const {
+  size_t m = pattern_.length();
+  size_t n = text.length();
+  if (m == 0 || n == 0) return CapDistance(std::max(m, n), max_distance);
+  if (ExceedsMaxDistance(std::max(m, n), std::min(m, n), max_distance)) {
+    return max_distance + 1;
+  }
+  if (m > kMaxBitParallelLength) return DistanceByTable(text, max_distance);
+
+  // |positive| and |negative| have a bit set for each row of the current
+  // column whose value is 1 more or 1 less than the row above. The bits past
+  // the pattern are never carried into it, so they don't need to be masked.
+  uint64_t positive = ~uint64_t{0};
+  uint64_t negative = 0;
+  uint64_t last = uint64_t{1} << (m - 1);
+  size_t distance = m;
+  for (size_t j = 0; j < n; ++j) {
+    uint64_t equal = masks_[static_cast<uint8_t>(text[j])];
+    uint64_t vertical = equal | negative;
+    uint64_t horizontal =
+        (((equal & positive) + positive) ^ positive) | equal;
+    uint64_t horizontal_positive = negative | ~(horizontal | positive);
+    uint64_t horizontal_negative = positive & horizontal;
+    if (horizontal_positive & last) {
+      distance++;
+    } else if (horizontal_negative & last) {
+      distance--;
+    }
+    // The first row grows by 1 per column.
+    horizontal_positive = (horizontal_positive << 1) | 1;
+    horizontal_negative <<= 1;
+    positive = horizontal_negative | ~(vertical | horizontal_positive);
+    negative = horizontal_positive & vertical;
+
+    if (ExceedsMaxDistance(distance, n - j - 1, max_distance)) {
+      return max_distance + 1;
+    }
+  }
+  return CapDistance(distance, max_distance);
+}
+
+size_t EditDistanceMatcher::DistanceByTable(absl::string_view text,
+                                            size_t max_distance) const {
+  size_t m = pattern_.length();
+  size_t n = text.length();
+  std::vector<size_t> costs(n + 1);
+  for (size_t j = 0; j <= n; ++j) costs[j] = j;
+
+  for (size_t i = 0; i < m; ++i) {
+    costs[0] = i + 1;
+    size_t corner = i;
+    size_t min = costs[0];
+    char c = pattern_[i];
+    for (size_t j = 0; j < n; ++j) {
+      size_t upper = costs[j + 1];
+      if (c == text[j]) {
+        costs[j + 1] = corner;
+      } else {
+        costs[j + 1] = std::min({costs[j], upper, corner}) + 1;
+      }
+      corner = upper;
+      min = std::min(min, costs[j + 1]);
+    }
+    // No row has a smaller minimum than the one above it.
+    if (min > max_distance) return max_distance + 1;
+  }
+  return CapDistance(costs[n], max_distance);
+}
+
+size_t GetEditDistance(absl::string_view a, absl::string_view b,
+                       size_t max_distance) {
+  // The distance is symmetric, and the shorter pattern is more likely to fit
+  // in a word.
+  if (a.length() > b.length()) std::swap(a, b);
+  return EditDistanceMatcher(a).Distance(b, max_distance);
+}
+
+}  // namespace console
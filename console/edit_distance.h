@@ -0,0 +1,54 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_EDIT_DISTANCE_H_
+#define CONSOLE_EDIT_DISTANCE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <limits>
+
+#include "absl/strings/string_view.h"
+#include "console/export.h"
+
+namespace console {
+
+// EditDistanceMatcher measures the Levenshtein distance from a pattern to
+// many texts. It uses the bit-parallel algorithm of Myers as extended by
+// Hyyrö, where a column of the dynamic programming table is a pair of bit
+// vectors, so a text costs a few word operations per character instead of
+// one cell per character of the pattern. Patterns longer than 64 characters
+// fall back to the table.
+//
+// EditDistanceMatcher matcher("--verbose");
+// matcher.Distance("--verbos");  // 1
+class CONSOLE_EXPORT EditDistanceMatcher {
+ public:
+  // |pattern| must outlive this.
+  explicit EditDistanceMatcher(absl::string_view pattern);
+
+  // Returns the distance from the pattern to |text|. If it is larger than
+  // |max_distance|, returns |max_distance| + 1 as soon as that is known,
+  // without reading the rest of |text|.
+  size_t Distance(
+      absl::string_view text,
+      size_t max_distance = std::numeric_limits<size_t>::max()) const;
+
+ private:
+  size_t DistanceByTable(absl::string_view text, size_t max_distance) const;
+
+  absl::string_view pattern_;
+  // The positions of each character in the pattern, as a bit mask.
+  uint64_t masks_[256];
+};
+
+// Same as EditDistanceMatcher(a).Distance(b, max_distance).
+CONSOLE_EXPORT size_t
+GetEditDistance(absl::string_view a, absl::string_view b,
+                size_t max_distance = std::numeric_limits<size_t>::max());
+
+}  // namespace console
+
+#endif  // CONSOLE_EDIT_DISTANCE_H_
@@ -0,0 +1,78 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/edit_distance.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace console {
+
+namespace {
+
+size_t GetEditDistanceByTable(const std::string& a, const std::string& b) {
+  std::vector<std::vector<size_t>> table(a.size() + 1,
+                                         std::vector<size_t>(b.size() + 1));
+  for (size_t i = 0; i <= a.size(); ++i) table[i][0] = i;
+  for (size_t j = 0; j <= b.size(); ++j) table[0][j] = j;
+  for (size_t i = 1; i <= a.size(); ++i) {
+    for (size_t j = 1; j <= b.size(); ++j) {
+      table[i][j] = std::min({table[i - 1][j] + 1, table[i][j - 1] + 1,
+                              table[i - 1][j - 1] + (a[i - 1] != b[j - 1])});
+    }
+  }
+  return table[a.size()][b.size()];
+}
+
+std::string GetRandomString(std::mt19937* random, size_t max_length) {
+  std::uniform_int_distribution<size_t> length(0, max_length);
+  // A small alphabet makes close strings likely.
+  std::uniform_int_distribution<int> c('a', 'd');
+  std::string text(length(*random), ' ');
+  for (char& ch : text) ch = static_cast<char>(c(*random));
+  return text;
+}
+
+}  // namespace
+
+TEST(EditDistanceTest, Distance) {
+  EXPECT_EQ(GetEditDistance("", ""), 0u);
+  EXPECT_EQ(GetEditDistance("", "abc"), 3u);
+  EXPECT_EQ(GetEditDistance("abc", ""), 3u);
+  EXPECT_EQ(GetEditDistance("kitten", "sitting"), 3u);
+  EXPECT_EQ(GetEditDistance("--verbose", "--verbos"), 1u);
+  EXPECT_EQ(GetEditDistance("--val", "--value"), 2u);
+}
+
+TEST(EditDistanceTest, MaxDistance) {
+  EXPECT_EQ(GetEditDistance("kitten", "sitting", 3), 3u);
+  EXPECT_EQ(GetEditDistance("kitten", "sitting", 2), 3u);
+  EXPECT_EQ(GetEditDistance("kitten", "sitting", 0), 1u);
+  EXPECT_EQ(GetEditDistance("a", "abcdef", 2), 3u);
+}
+
+TEST(EditDistanceTest, Random) {
+  std::mt19937 random(42);
+  for (int i = 0; i < 2000; ++i) {
+    // Some patterns are longer than a word.
+    size_t max_length = i % 10 == 0 ? 100 : 20;
+    std::string a = GetRandomString(&random, max_length);
+    std::string b = GetRandomString(&random, max_length);
+    size_t expected = GetEditDistanceByTable(a, b);
+    EditDistanceMatcher matcher(a);
+    ASSERT_EQ(matcher.Distance(b), expected) << a << " " << b;
+    for (size_t max_distance = 0; max_distance < expected + 2;
+         ++max_distance) {
+      ASSERT_EQ(matcher.Distance(b, max_distance),
+                std::min(expected, max_distance + 1))
+          << a << " " << b << " " << max_distance;
+    }
+  }
+}
+
+}  // namespace console
@@ -7,8 +7,10 @@
 #include <algorithm>
 
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "base/strings/string_util.h"
+#include "console/tracing.h"
 
 namespace console {
 
@@ -16,6 +18,8 @@ namespace {
 
 constexpr const int kDefaultLineWidth = 50;
 constexpr const int kDefaultHelpStart = 20;
+constexpr const size_t kMaxSuggestions = 3;
+constexpr const int kMaxResponseFileDepth = 8;
 
 bool ContainsOnlyAsciiAlphaOrDigitOrUndderscore(absl::string_view text) {
   const char* p = text.data();
@@ -46,66 +50,90 @@ std::string AlignAtIndexAndAppend(std::stringstream& ss, absl::string_view text,
   return ss.str();
 }
 
-struct Costs {
-  Costs(size_t size) : size(size) {
-    if (size > 256) {
-      costs = new size_t[size];
-    } else {
-      costs = costs_on_stack;
-    }
-    Init();
+// Returns "\"a\"", "\"a\" or \"b\"", "\"a\", \"b\" or \"c\"" and so on.
+std::string JoinSuggestions(const std::vector<absl::string_view>& names) {
+  std::string text;
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (i > 0) text += i + 1 == names.size() ? " or " : ", ";
+    absl::StrAppend(&text, "\"", names[i], "\"");
   }
+  return text;
+}
 
-  void Init() {
-    for (size_t i = 0; i < size; ++i) {
-      costs[i] = i;
-    }
-  }
+bool IsResponseFileWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
 
-  ~Costs() {
-    if (size > 256) {
-      delete[] costs;
-    }
+// Consumes the next argument of a response file from |data| into |raw|, as
+// it is written. |plain| is set to false if it has quotes or escapes.
+// Returns false at the end of |data|, or at an unterminated quote, which is
+// left in |data|.
+bool NextResponseFileArgument(absl::string_view* data, absl::string_view* raw,
+                              bool* plain) {
+  size_t start = 0;
+  while (start < data->length() && IsResponseFileWhitespace((*data)[start])) {
+    start++;
   }
+  data->remove_prefix(start);
+  if (data->empty()) return false;
 
-  size_t& operator[](size_t i) { return costs[i]; }
-
-  size_t size;
-  size_t* costs = nullptr;
-  size_t costs_on_stack[256];
-};
-
-// This was taken and modified from
-// https://rosettacode.org/wiki/Levenshtein_distance#C.2B.2B
-size_t GetLevenshteinDistance(absl::string_view s1, absl::string_view s2) {
-  size_t m = s1.size();
-  size_t n = s2.size();
-
-  if (m == 0) return n;
-  if (n == 0) return m;
-
-  Costs costs(n + 1);
-
+  char quote = '\0';
+  *plain = true;
   size_t i = 0;
-  for (; i < m; ++i) {
-    costs[0] = i + 1;
-    size_t corner = i;
-    size_t j = 0;
-    char c = s1[i];
-    for (; j < n; ++j) {
-      size_t upper = costs[j + 1];
-      if (c == s2[j]) {
-        costs[j + 1] = corner;
-      } else {
-        size_t t = upper < corner ? upper : corner;
-        costs[j + 1] = (costs[j] < t ? costs[j] : t) + 1;
+  for (; i < data->length(); ++i) {
+    char c = (*data)[i];
+    if (quote != '\0') {
+      if (c == quote) {
+        quote = '\0';
+      } else if (c == '\\' && quote == '"') {
+        ++i;
       }
-
-      corner = upper;
+    } else if (c == '\'' || c == '"') {
+      quote = c;
+      *plain = false;
+    } else if (c == '\\') {
+      ++i;
+      *plain = false;
+    } else if (IsResponseFileWhitespace(c)) {
+      break;
     }
   }
+  if (quote != '\0') return false;
+  i = std::min(i, data->length());
+  *raw = data->substr(0, i);
+  data->remove_prefix(i);
+  return true;
+}
 
-  return costs[n];
+// Returns true if |raw| is a single quoted string without escapes, which
+// doesn't need to be copied to be unquoted.
+bool IsQuotedWithoutEscape(absl::string_view raw) {
+  if (raw.length() < 2 || (raw[0] != '\'' && raw[0] != '"') ||
+      raw.front() != raw.back()) {
+    return false;
+  }
+  absl::string_view text = raw.substr(1, raw.length() - 2);
+  return text.find_first_of(raw[0] == '"' ? "\"\\" : "'") ==
+         absl::string_view::npos;
+}
+
+std::string Unescape(absl::string_view raw) {
+  std::string text;
+  text.reserve(raw.length());
+  char quote = '\0';
+  for (size_t i = 0; i < raw.length(); ++i) {
+    char c = raw[i];
+    if (quote != '\0' && c == quote) {
+      quote = '\0';
+    } else if (quote == '\0' && (c == '\'' || c == '"')) {
+      quote = c;
+    } else if (quote != '\'' && c == '\\') {
+      if (i + 1 < raw.length()) text += raw[++i];
+    } else {
+      text += c;
+    }
+  }
+  return text;
 }
 
 }  // namespace
@@ -120,6 +148,7 @@ FlagBase& FlagBase::set_short_name(absl::string_view short_name) {
   if (!ContainsOnlyAsciiAlphaOrDigitOrUndderscore(text)) return *this;
 
   short_name_ = std::string(short_name);
+  Changed();
   return *this;
 }
 
@@ -129,6 +158,7 @@ FlagBase& FlagBase::set_long_name(absl::string_view long_name) {
   if (!ContainsOnlyAsciiAlphaOrDigitOrUndderscore(text)) return *this;
 
   long_name_ = std::string(long_name);
+  Changed();
   return *this;
 }
 
@@ -137,6 +167,7 @@ FlagBase& FlagBase::set_name(absl::string_view name) {
   if (!ContainsOnlyAsciiAlphaOrDigitOrUndderscore(text)) return *this;
 
   name_ = std::string(name);
+  Changed();
   return *this;
 }
 
@@ -147,11 +178,13 @@ FlagBase& FlagBase::set_help(absl::string_view help) {
 
 FlagBase& FlagBase::set_required() {
   is_required_ = true;
+  Changed();
   return *this;
 }
 
 FlagBase& FlagBase::set_sequential() {
   is_sequential_ = true;
+  Changed();
   return *this;
 }
 
@@ -218,29 +251,15 @@ std::string FlagBase::display_usage() const {
   }
 }
 
-bool FlagBase::ConsumeNamePrefix(FlagParser& parser,
-                                 absl::string_view* arg) const {
-  absl::string_view input = *arg;
-  if (!long_name_.empty()) {
-    if (base::ConsumePrefix(&input, long_name_)) {
-      if (input.empty() || input[0] == '=') {
-        *arg = input;
-        return true;
-      }
-    }
-  }
-  if (!short_name_.empty()) {
-    if (base::ConsumePrefix(&input, short_name_)) {
-      if (input.empty() || input[0] == '=') {
-        *arg = input;
-        return true;
-      }
-    }
-  }
-  return false;
+bool FlagBase::IsSubParser() const { return false; }
+
+void FlagBase::Changed() {
+  if (parser_) parser_->InvalidatePlan();
 }
 
-bool FlagBase::IsSubParser() const { return false; }
+FlagParser::Plan::Plan() = default;
+
+FlagParser::Plan::~Plan() = default;
 
 FlagParser::FlagParser() = default;
 
@@ -264,52 +283,74 @@ const std::string& FlagParser::error_message() {
 }
 
 FlagBase& FlagParser::AddFlag(std::unique_ptr<FlagBase> flag_base) {
+  flag_base->parser_ = this;
   flags_.push_back(std::move(flag_base));
+  InvalidatePlan();
   return *flags_.back().get();
 }
 
 SubParser& FlagParser::AddSubParser() {
   std::unique_ptr<SubParser> sub_parser(new SubParser());
-  flags_.push_back(std::move(sub_parser));
+  AddFlag(std::move(sub_parser));
   return *reinterpret_cast<SubParser*>(flags_.back().get());
 }
 
 bool FlagParser::Validate() {
+  const Plan& plan = GetPlan();
+  if (!plan.valid) error_message_ = plan.error_message;
+  return plan.valid;
+}
+
+const FlagParser::Plan& FlagParser::GetPlan() {
+  if (!plan_) plan_ = BuildPlan();
+  return *plan_;
+}
+
+void FlagParser::InvalidatePlan() {
+  plan_.reset();
+  flag_names_.reset();
+}
+
+std::unique_ptr<const FlagParser::Plan> FlagParser::BuildPlan() {
+  CONSOLE_TRACE_EVENT("FlagParser::BuildPlan");
+  std::unique_ptr<Plan> plan(new Plan());
+  std::string& error_message = plan->error_message;
   bool is_positional = true;
   bool has_subparser = false;
   for (auto& flag : flags_) {
     if (!(flag->is_positional() || flag->is_optional())) {
-      error_message_ = "Flag should be positional or optional.";
-      return false;
+      error_message = "Flag should be positional or optional.";
+      return plan;
     }
 
     if (flag->is_positional() && flag->is_optional()) {
-      error_message_ = absl::Substitute(
+      error_message = absl::Substitute(
           "\"$0\" is positional and optional, please choose either one of "
           "them.",
           flag->name());
-      return false;
+      return plan;
     }
 
     if (flag->IsSubParser()) {
       if (flag->is_optional()) {
-        error_message_ = absl::Substitute(
+        error_message = absl::Substitute(
             "Subparser \"$0\" should be positional.", flag->display_name());
-        return false;
+        return plan;
       }
 
       has_subparser = true;
       SubParser* sub_parser = reinterpret_cast<SubParser*>(flag.get());
       if (!sub_parser->Validate()) {
-        return false;
+        error_message = sub_parser->error_message();
+        return plan;
       }
     } else {
       if (flag->is_positional()) {
         if (!is_positional) {
-          error_message_ = absl::Substitute(
+          error_message = absl::Substitute(
               "\"$0\" should be before any optional arguments.",
               flag->display_name());
-          return false;
+          return plan;
         }
       } else {
         is_positional = false;
@@ -318,11 +359,11 @@ bool FlagParser::Validate() {
 
     if (!flag->NeedsValue()) {
       if (flag->is_positional()) {
-        error_message_ = absl::Substitute(
+        error_message = absl::Substitute(
             "\"$0\" can't parse a value, how about considering using "
             "set_short_name() or set_long_name()?",
             flag->name());
-        return false;
+        return plan;
       }
     }
   }
@@ -331,38 +372,81 @@ bool FlagParser::Validate() {
     for (auto& flag : flags_) {
       if (flag->is_positional()) {
         if (!flag->IsSubParser()) {
-          error_message_ = absl::Substitute(
+          error_message = absl::Substitute(
               "\"$0\" can't be positional if the parser has "
               "subparser, how about considering using "
               "set_short_name() or set_long_name()?",
               flag->name());
-          return false;
+          return plan;
         }
       }
     }
   }
 
-  return true;
+  // emplace() keeps the first flag of a name, which is the one a linear scan
+  // would find.
+  for (auto& flag : flags_) {
+    if (flag->is_required()) plan->required_flags.push_back(flag.get());
+    if (flag->is_positional()) {
+      plan->positional_flags.push_back(flag.get());
+      if (flag->IsSubParser()) {
+        plan->sub_parsers.emplace(flag->name(), flag.get());
+      }
+      continue;
+    }
+    OptionalFlag optional_flag = {flag.get(), flag->NeedsValue()};
+    if (!flag->long_name().empty()) {
+      plan->optional_flags.emplace(flag->long_name(), optional_flag);
+    }
+    if (!flag->short_name().empty()) {
+      plan->optional_flags.emplace(flag->short_name(), optional_flag);
+    }
+  }
+  plan->has_subparser =
+      !plan->positional_flags.empty() && flags_[0]->IsSubParser();
+  plan->valid = true;
+  return plan;
 }
 
 bool FlagParser::Parse(int argc, char** argv, int from) {
+  CONSOLE_TRACE_EVENT("FlagParser::Parse");
+  arguments_.clear();
+  response_files_.clear();
+  unescaped_arguments_.clear();
+  arguments_.reserve(argc);
+  for (int i = 0; i < argc; ++i) {
+    absl::string_view arg = argv[i];
+    if (allows_response_files_ && i >= from && arg.length() > 1 &&
+        arg[0] == '@') {
+      if (!ExpandResponseFile(arg.substr(1), 1)) return false;
+    } else {
+      arguments_.push_back(arg);
+    }
+  }
+  return ParseArguments(arguments_, from);
+}
+
+void FlagParser::set_allows_response_files(bool allows_response_files) {
+  allows_response_files_ = allows_response_files;
+}
+
+bool FlagParser::allows_response_files() const {
+  return allows_response_files_;
+}
+
+bool FlagParser::ParseArguments(const std::vector<absl::string_view>& args,
+                                size_t from) {
   current_idx_ = from;
-  argc_ = argc;
-  argv_ = argv;
+  args_ = &args;
 
   if (!Validate()) return false;
+  const Plan& plan = *plan_;
 
-  int positional_parsed = 0;
-  int positional_argument = std::count_if(
-      flags_.begin(), flags_.end(), [](const std::unique_ptr<FlagBase>& flag) {
-        return flag->is_positional();
-      });
-  bool has_subparser = false;
-  if (positional_argument > 0) {
-    has_subparser = flags_[0]->IsSubParser();
-  }
+  size_t positional_parsed = 0;
+  size_t positional_argument = plan.positional_flags.size();
+  bool has_subparser = plan.has_subparser;
 
-  while (current_idx_ < argc_) {
+  while (current_idx_ < args_->size()) {
     absl::string_view arg = current();
     if (arg == "--help" || arg == "-h") {
       std::cerr << help_message() << std::endl;
@@ -372,35 +456,18 @@ bool FlagParser::Parse(int argc, char** argv, int from) {
 
     FlagBase* target_flag = nullptr;
     if (has_subparser) {
-      for (int i = 0; i < positional_argument; ++i) {
-        if (flags_[i]->name() == arg) {
-          target_flag = flags_[i].get();
-          break;
-        }
-      }
+      auto it = plan.sub_parsers.find(arg);
+      if (it != plan.sub_parsers.end()) target_flag = it->second;
     }
 
+    bool needs_value = false;
     if (!has_subparser && positional_parsed < positional_argument) {
-      int positional_idx = 0;
-      for (auto& flag : flags_) {
-        if (flag->is_optional())
-          continue;
-        else {
-          if (positional_idx == positional_parsed) {
-            target_flag = flag.get();
-            break;
-          }
-
-          positional_idx++;
-        }
-      }
+      target_flag = plan.positional_flags[positional_parsed];
     } else {
-      for (auto& flag : flags_) {
-        if (flag->is_positional()) continue;
-
-        if (!flag->ConsumeNamePrefix(*this, &arg)) continue;
-        target_flag = flag.get();
-        break;
+      const OptionalFlag* optional_flag = ConsumeOptionalFlag(plan, &arg);
+      if (optional_flag) {
+        target_flag = optional_flag->flag;
+        needs_value = optional_flag->needs_value;
       }
     }
 
@@ -412,12 +479,12 @@ bool FlagParser::Parse(int argc, char** argv, int from) {
         SubParser* sub_parser = reinterpret_cast<SubParser*>(target_flag);
         sub_parser->set_program_name(
             absl::Substitute("$0 $1", program_name_, target_flag->name()));
-        return sub_parser->Parse(argc, argv, current_idx_ + 1);
+        return sub_parser->ParseArguments(args, current_idx_ + 1);
       } else if (target_flag->is_positional()) {
         parsed = target_flag->ParseValue(arg, &reason);
         positional_parsed++;
       } else {
-        if (target_flag->NeedsValue() && !ConsumeEqualOrProceed(&arg)) {
+        if (needs_value && !ConsumeEqualOrProceed(&arg)) {
           error_message_ = absl::Substitute(
               "\"$0\" is failed to parse: (reason: empty value ).",
               target_flag->display_name());
@@ -439,12 +506,12 @@ bool FlagParser::Parse(int argc, char** argv, int from) {
                                target_flag->display_name(), reason);
         }
       } else {
-        absl::string_view candidate_arg;
-        bool found = FindTheMostSimilarFlag(arg, &candidate_arg);
-        if (found) {
+        std::vector<absl::string_view> names =
+            FindSimilarFlagNames(arg, kMaxSuggestions);
+        if (!names.empty()) {
           error_message_ = absl::Substitute(
-              "met unknown argument: \"$0\", maybe you mean \"$1\"?", arg,
-              candidate_arg);
+              "met unknown argument: \"$0\", maybe you mean $1?", arg,
+              JoinSuggestions(names));
         } else {
           error_message_ =
               absl::Substitute("met unknown argument: \"$0\".", arg);
@@ -456,8 +523,7 @@ bool FlagParser::Parse(int argc, char** argv, int from) {
   }
 
   if (!has_subparser && positional_parsed < positional_argument) {
-    for (auto& flag : flags_) {
-      if (flag->is_optional()) continue;
+    for (FlagBase* flag : plan.positional_flags) {
       if (!flag->is_set()) {
         error_message_ = absl::Substitute("\"$0\" is positional, but not set.",
                                           flag->name());
@@ -466,8 +532,8 @@ bool FlagParser::Parse(int argc, char** argv, int from) {
     }
   }
 
-  for (auto& flag : flags_) {
-    if (flag->is_required() && !flag->is_set()) {
+  for (FlagBase* flag : plan.required_flags) {
+    if (!flag->is_set()) {
       error_message_ = absl::Substitute("\"$0\" is required, but not set.",
                                         flag->display_name());
       return false;
@@ -477,7 +543,50 @@ bool FlagParser::Parse(int argc, char** argv, int from) {
   return true;
 }
 
-absl::string_view FlagParser::current() { return argv_[current_idx_]; }
+bool FlagParser::ExpandResponseFile(absl::string_view path, int depth) {
+  if (depth > kMaxResponseFileDepth) {
+    error_message_ = absl::Substitute(
+        "response file \"$0\" is nested too deeply (max: $1).", path,
+        kMaxResponseFileDepth);
+    return false;
+  }
+  std::unique_ptr<MemoryMappedFile> file(new MemoryMappedFile());
+  if (!file->Initialize(std::string(path))) {
+    error_message_ =
+        absl::Substitute("failed to read response file \"$0\".", path);
+    return false;
+  }
+  absl::string_view data = file->data();
+  response_files_.push_back(std::move(file));
+
+  absl::string_view raw;
+  bool plain;
+  while (NextResponseFileArgument(&data, &raw, &plain)) {
+    if (!plain) {
+      if (!IsQuotedWithoutEscape(raw)) {
+        unescaped_arguments_.push_back(Unescape(raw));
+        arguments_.push_back(unescaped_arguments_.back());
+      } else {
+        arguments_.push_back(raw.substr(1, raw.length() - 2));
+      }
+    } else if (raw.length() > 1 && raw[0] == '@') {
+      if (!ExpandResponseFile(raw.substr(1), depth + 1)) return false;
+    } else {
+      arguments_.push_back(raw);
+    }
+  }
+  if (!data.empty()) {
+    error_message_ = absl::Substitute(
+        "response file \"$0\" has an unterminated quote.", path);
+    return false;
+  }
+  return true;
+}
+
+absl::string_view FlagParser::current() {
+  if (current_idx_ >= args_->size()) return absl::string_view();
+  return (*args_)[current_idx_];
+}
 
 bool FlagParser::ConsumeEqualOrProceed(absl::string_view* arg) {
   if (base::ConsumePrefix(arg, "=")) return true;
@@ -488,33 +597,56 @@ bool FlagParser::ConsumeEqualOrProceed(absl::string_view* arg) {
 }
 
 void FlagParser::Proceed() {
-  if (current_idx_ < argc_) current_idx_++;
+  if (current_idx_ < args_->size()) current_idx_++;
+}
+
+const FlagParser::OptionalFlag* FlagParser::ConsumeOptionalFlag(
+    const Plan& plan, absl::string_view* arg) const {
+  // Names can't contain "=", so the name ends at the first one.
+  size_t equal = arg->find('=');
+  absl::string_view name = arg->substr(0, equal);
+  auto it = plan.optional_flags.find(name);
+  if (it == plan.optional_flags.end()) return nullptr;
+  arg->remove_prefix(name.length());
+  return &it->second;
 }
 
-bool FlagParser::FindTheMostSimilarFlag(absl::string_view input,
-                                        absl::string_view* output) {
-  size_t theshold = (input.length() + 1) / 2;
-  size_t min = std::numeric_limits<size_t>::max();
+// FNV-1a, which is fast for short keys such as the names of flags.
+size_t FlagParser::StringViewHash::operator()(absl::string_view text) const {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : text) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  return static_cast<size_t>(hash);
+}
 
-  for (auto& flag : flags_) {
-    if (!flag->short_name().empty()) {
-      size_t dist = GetLevenshteinDistance(input, flag->short_name());
-      if (dist <= theshold && dist < min) {
-        *output = flag->short_name();
-        min = dist;
+std::vector<absl::string_view> FlagParser::FindSimilarFlagNames(
+    absl::string_view input, size_t max_count) {
+  if (!flag_names_) {
+    flag_names_.reset(new BKTree());
+    for (auto& flag : flags_) {
+      if (flag->IsSubParser()) {
+        flag_names_->Insert(flag->name());
+        continue;
       }
+      if (!flag->short_name().empty()) flag_names_->Insert(flag->short_name());
+      if (!flag->long_name().empty()) flag_names_->Insert(flag->long_name());
     }
+  }
 
-    if (!flag->long_name().empty()) {
-      size_t dist = GetLevenshteinDistance(input, flag->long_name());
-      if (dist <= theshold && dist < min) {
-        *output = flag->long_name();
-        min = dist;
-      }
+  size_t threshold = (input.length() + 1) / 2;
+  std::vector<BKTree::Match> matches = flag_names_->Find(input, threshold);
+  std::vector<absl::string_view> names;
+  // Only the closest names are suggested, since a farther one is rarely
+  // what was meant when there is a closer one.
+  for (const BKTree::Match& match : matches) {
+    if (names.size() == max_count || match.distance > matches[0].distance) {
+      break;
     }
+    names.push_back(match.word);
   }
-
-  return min < std::numeric_limits<size_t>::max();
+  return names;
 }
 
 std::string FlagParser::help_message() {
@@ -593,4 +725,9 @@ bool SubParser::ParseValue(absl::string_view arg, std::string* reason) {
   return false;
 }
 
+void SubParser::InvalidatePlan() {
+  FlagParser::InvalidatePlan();
+  Changed();
+}
+
 }  // namespace console
\ No newline at end of file
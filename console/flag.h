@@ -7,16 +7,20 @@
 
 #include <stddef.h>
 
+#include <deque>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "base/strings/string_util.h"
+#include "console/bk_tree.h"
 #include "console/export.h"
 #include "console/flag_forward.h"
 #include "console/flag_value_traits.h"
+#include "console/memory_mapped_file.h"
 
 namespace console {
 
@@ -67,8 +71,6 @@ class CONSOLE_EXPORT FlagBase {
   std::string display_usage() const;
   std::string display_help(int help_start = 0) const;
 
-  bool ConsumeNamePrefix(FlagParser& parser, absl::string_view* arg) const;
-
   virtual bool IsSubParser() const;
   // Returns true if underlying type of Flag<T>, in other words, T is bool.
   virtual bool NeedsValue() const = 0;
@@ -81,6 +83,12 @@ class CONSOLE_EXPORT FlagBase {
   bool is_required_ = false;
   bool is_sequential_ = false;
   bool is_set_ = false;
+
+  // Notifies |parser_| that the flag changed.
+  void Changed();
+
+  // The parser the flag was added to.
+  FlagParser* parser_ = nullptr;
 };
 
 template <typename T>
@@ -148,54 +156,124 @@ class CONSOLE_EXPORT FlagParser {
 
   template <typename T, typename value_type = typename Flag<T>::value_type>
   FlagBase& AddFlag(value_type* value) {
-    std::unique_ptr<FlagBase> flag(new T(value));
-    flags_.push_back(std::move(flag));
-    return *flags_.back().get();
+    return AddFlag(std::unique_ptr<FlagBase>(new T(value)));
   }
 
   template <typename T, typename value_type = typename Flag<T>::value_type>
   FlagBase& AddFlag(value_type* value, const value_type& default_value) {
-    std::unique_ptr<FlagBase> flag(new T(value, default_value));
-    flags_.push_back(std::move(flag));
-    return *flags_.back().get();
+    return AddFlag(std::unique_ptr<FlagBase>(new T(value, default_value)));
   }
 
   template <typename T,
             typename ParseValueCallback = typename Flag<T>::ParseValueCallback>
   FlagBase& AddFlag(ParseValueCallback parse_value_callback) {
-    std::unique_ptr<FlagBase> flag(new T(parse_value_callback));
-    flags_.push_back(std::move(flag));
-    return *flags_.back().get();
+    return AddFlag(std::unique_ptr<FlagBase>(new T(parse_value_callback)));
   }
 
   FlagBase& AddFlag(std::unique_ptr<FlagBase> flag_base);
 
   SubParser& AddSubParser();
 
+  // The result is kept until a flag is added or changed, so this validates
+  // the flags only once however many times it is called.
   bool Validate();
 
+  // The first call validates the flags and builds a plan of how to parse
+  // them, which the next calls reuse until a flag is added or changed. With
+  // the plan, each argument is looked up in time proportional to its length.
   bool Parse(int argc, char** argv, int from = 1);
 
+  // If enabled, an argument "@path" is replaced by the arguments in the file
+  // at |path|, so that there can be more than the OS allows on a command
+  // line. The file is mapped into memory and the arguments refer to it
+  // until the next Parse(). They are separated by whitespace and can be
+  // quoted by '' or "" and escaped by a backslash, which is the only case
+  // where an argument is copied. A file can include other files the same
+  // way, up to a depth of 8. On Windows, the files can't be truncated until
+  // the next Parse(). It is disabled by default.
+  void set_allows_response_files(bool allows_response_files);
+  bool allows_response_files() const;
+
   // It marks virtual so that users can make custom help messages.
   virtual std::string help_message();
 
  protected:
   friend class Autocompletion;
+  friend class FlagBase;
+
+  struct StringViewHash {
+    size_t operator()(absl::string_view text) const;
+  };
+
+  struct OptionalFlag {
+    FlagBase* flag;
+    bool needs_value;
+  };
+
+  // What Parse() derives from the flags. It is immutable once built, and
+  // replaced when a flag is added or changed.
+  struct Plan {
+    Plan();
+    ~Plan();
+
+    bool valid = false;
+    // Why the flags are not valid.
+    std::string error_message;
+    // The optional flags by their short and long names, and the subparsers
+    // by their names. The keys refer to the names of the flags.
+    std::unordered_map<absl::string_view, OptionalFlag, StringViewHash>
+        optional_flags;
+    std::unordered_map<absl::string_view, FlagBase*, StringViewHash>
+        sub_parsers;
+    std::vector<FlagBase*> positional_flags;
+    std::vector<FlagBase*> required_flags;
+    // True if the positional arguments are subparsers.
+    bool has_subparser = false;
+  };
+
+  // Returns the plan, building it if there is none.
+  const Plan& GetPlan();
+  std::unique_ptr<const Plan> BuildPlan();
+  // Drops the plan. A SubParser also drops the plan of its parent, which
+  // includes its validation.
+  virtual void InvalidatePlan();
+
+  // Parses |args| from |from|, which outlive the call. SubParsers parse the
+  // arguments of their parent from where it stopped.
+  bool ParseArguments(const std::vector<absl::string_view>& args, size_t from);
+  // Appends the arguments in the response file at |path| to |arguments_|.
+  bool ExpandResponseFile(absl::string_view path, int depth);
 
   absl::string_view current();
   bool ConsumeEqualOrProceed(absl::string_view* arg);
   void Proceed();
 
-  // Internally it measures Levenshtein distance among arguments.
-  bool FindTheMostSimilarFlag(absl::string_view input,
-                              absl::string_view* output);
+  // Returns the optional flag |arg| starts with, followed by the end or "=",
+  // and consumes its name from |arg|. Returns nullptr if there is none.
+  const OptionalFlag* ConsumeOptionalFlag(const Plan& plan,
+                                          absl::string_view* arg) const;
+
+  // Returns up to |max_count| names of flags and subparsers closest to
+  // |input| by Levenshtein distance, if any is close enough. The names are
+  // indexed on the first call, until a flag is added or changed.
+  std::vector<absl::string_view> FindSimilarFlagNames(absl::string_view input,
+                                                      size_t max_count);
 
   std::string program_name_;
-  int argc_;
-  int current_idx_;
-  char** argv_;
+  const std::vector<absl::string_view>* args_ = nullptr;
+  size_t current_idx_ = 0;
   std::string error_message_;
+  bool allows_response_files_ = false;
+  // The arguments given to Parse() with the response files expanded, and
+  // what they refer to besides |argv|.
+  std::vector<absl::string_view> arguments_;
+  std::vector<std::unique_ptr<MemoryMappedFile>> response_files_;
+  std::deque<std::string> unescaped_arguments_;
   std::vector<std::unique_ptr<FlagBase>> flags_;
+  std::unique_ptr<const Plan> plan_;
+  // The names of the flags and subparsers, for suggestions. The names refer
+  // to the flags, so it is dropped with |plan_|.
+  std::unique_ptr<BKTree> flag_names_;
 };
 
 class CONSOLE_EXPORT SubParser : public FlagBase, public FlagParser {
@@ -209,6 +287,10 @@ class CONSOLE_EXPORT SubParser : public FlagBase, public FlagParser {
   bool IsSubParser() const override;
   bool NeedsValue() const override;
   bool ParseValue(absl::string_view arg, std::string* reason) override;
+
+ protected:
+  // FlagParser methods
+  void InvalidatePlan() override;
 };
 
 }  // namespace console
@@ -4,6 +4,12 @@
 
 #include "console/flag.h"
 
+#include <stdio.h>
+
+#include <fstream>
+#include <string>
+
+#include "console/console.h"
 #include "gtest/gtest.h"
 
 namespace console {
@@ -138,6 +144,37 @@ TEST(FlagParserTest, UndefinedArgument) {
   }
 }
 
+TEST(FlagParserTest, Suggestions) {
+  FlagParser parser;
+  uint16_t value;
+  parser.AddFlag<Uint16Flag>(&value).set_long_name("--value");
+  parser.AddFlag<Uint16Flag>(&value).set_long_name("--valve");
+  {
+    const char* argv[] = {"program", "--valu", "16"};
+    EXPECT_FALSE(parser.Parse(3, const_cast<char**>(argv)));
+    EXPECT_EQ(parser.error_message(),
+              "met unknown argument: \"--valu\", maybe you mean \"--value\"?");
+  }
+  {
+    const char* argv[] = {"program", "--val", "16"};
+    EXPECT_FALSE(parser.Parse(3, const_cast<char**>(argv)));
+    EXPECT_EQ(parser.error_message(),
+              "met unknown argument: \"--val\", maybe you mean \"--value\" "
+              "or \"--valve\"?");
+  }
+
+  // Commands are suggested too.
+  FlagParser command_parser;
+  command_parser.AddSubParser().set_name("add");
+  command_parser.AddSubParser().set_name("pow");
+  {
+    const char* argv[] = {"program", "ad", "1"};
+    EXPECT_FALSE(command_parser.Parse(3, const_cast<char**>(argv)));
+    EXPECT_EQ(command_parser.error_message(),
+              "met unknown argument: \"ad\", maybe you mean \"add\"?");
+  }
+}
+
 TEST(FlagParserTest, DefaultValue) {
   FlagParser parser;
   uint16_t value;
@@ -235,4 +272,144 @@ TEST(FlagParserTest, CustomParseValueCallback) {
   }
 }
 
-}  // namespace console
\ No newline at end of file
+TEST(FlagParserTest, ManyFlags) {
+  FlagParser parser;
+  std::vector<uint16_t> values(100);
+  for (size_t i = 0; i < values.size(); ++i) {
+    parser.AddFlag<Uint16Flag>(&values[i])
+        .set_long_name(absl::StrFormat("--flag%d", i))
+        .set_short_name(absl::StrFormat("-f%d", i));
+  }
+  {
+    const char* argv[] = {"program", "--flag42=1", "-f4", "2", "--flag4", "3"};
+    EXPECT_TRUE(parser.Parse(6, const_cast<char**>(argv)));
+    EXPECT_EQ(values[42], 1);
+    EXPECT_EQ(values[4], 3);
+  }
+  {
+    const char* argv[] = {"program", "--flag4x"};
+    EXPECT_FALSE(parser.Parse(2, const_cast<char**>(argv)));
+    EXPECT_EQ(parser.error_message(),
+              "met unknown argument: \"--flag4x\", maybe you mean "
+              "\"--flag4\", \"--flag40\" or \"--flag41\"?");
+  }
+
+  // A flag added after parsing is found by the next parse.
+  uint16_t value;
+  parser.AddFlag<Uint16Flag>(&value).set_long_name("--value");
+  {
+    const char* argv[] = {"program", "--value=5"};
+    EXPECT_TRUE(parser.Parse(2, const_cast<char**>(argv)));
+    EXPECT_EQ(value, 5);
+  }
+}
+
+TEST(FlagParserTest, PlanInvalidation) {
+  FlagParser parser;
+  uint16_t value;
+  FlagBase& flag = parser.AddFlag<Uint16Flag>(&value);
+  EXPECT_FALSE(parser.Validate());
+
+  // Changing a flag drops the cached result.
+  flag.set_long_name("--value");
+  EXPECT_TRUE(parser.Validate());
+  {
+    const char* argv[] = {"program", "--value", "1"};
+    EXPECT_TRUE(parser.Parse(3, const_cast<char**>(argv)));
+    EXPECT_EQ(value, 1);
+  }
+  flag.set_short_name("-v");
+  {
+    const char* argv[] = {"program", "-v", "2"};
+    EXPECT_TRUE(parser.Parse(3, const_cast<char**>(argv)));
+    EXPECT_EQ(value, 2);
+  }
+  uint16_t value2;
+  FlagBase& flag2 = parser.AddFlag<Uint16Flag>(&value2);
+  flag2.set_long_name("--value2");
+  flag2.set_required();
+  {
+    const char* argv[] = {"program"};
+    EXPECT_FALSE(parser.Parse(1, const_cast<char**>(argv)));
+    EXPECT_EQ(parser.error_message(), "\"--value2\" is required, but not set.");
+  }
+
+  // So does changing a flag of a subparser, whose validation is a part of
+  // its parent's.
+  SubParser& sub_parser = parser.AddSubParser();
+  sub_parser.set_name("sub");
+  uint16_t sub_value;
+  FlagBase& sub_flag = sub_parser.AddFlag<Uint16Flag>(&sub_value);
+  EXPECT_FALSE(parser.Validate());
+  EXPECT_EQ(parser.error_message(), "Flag should be positional or optional.");
+  sub_flag.set_short_name("-s");
+  EXPECT_TRUE(parser.Validate());
+}
+
+// On Windows, the files can't be rewritten while the parser keeps them mapped.
+#if !defined(OS_WIN)
+TEST(FlagParserTest, ResponseFiles) {
+  std::string outer_path = ::testing::TempDir() + "flag_unittest_outer.rsp";
+  std::string inner_path = ::testing::TempDir() + "flag_unittest_inner.rsp";
+  {
+    std::ofstream file(outer_path);
+    file << "--value 16\n--name 'a b' --text \"x \\\"y\\\"\"\t@" << inner_path
+         << "\n";
+  }
+  {
+    std::ofstream file(inner_path);
+    file << "  --count=3 \"--path\" a\\ b\n";
+  }
+
+  FlagParser parser;
+  uint16_t value = 0;
+  uint16_t count = 0;
+  std::string name;
+  std::string text;
+  std::string path;
+  parser.AddFlag<Uint16Flag>(&value).set_long_name("--value");
+  parser.AddFlag<Uint16Flag>(&count).set_long_name("--count");
+  parser.AddFlag<StringFlag>(&name).set_long_name("--name");
+  parser.AddFlag<StringFlag>(&text).set_long_name("--text");
+  parser.AddFlag<StringFlag>(&path).set_long_name("--path");
+
+  std::string outer_arg = "@" + outer_path;
+  const char* argv[] = {"program", outer_arg.c_str()};
+  EXPECT_FALSE(parser.Parse(2, const_cast<char**>(argv)));
+  EXPECT_EQ(parser.error_message(),
+            "met unknown argument: \"" + outer_arg + "\".");
+
+  parser.set_allows_response_files(true);
+  ASSERT_TRUE(parser.Parse(2, const_cast<char**>(argv)));
+  EXPECT_EQ(value, 16);
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(name, "a b");
+  EXPECT_EQ(text, "x \"y\"");
+  EXPECT_EQ(path, "a b");
+
+  {
+    std::ofstream file(inner_path);
+    file << "--name 'a b";
+  }
+  EXPECT_FALSE(parser.Parse(2, const_cast<char**>(argv)));
+  EXPECT_EQ(parser.error_message(),
+            "response file \"" + inner_path + "\" has an unterminated quote.");
+
+  // A file including itself is stopped by the depth limit.
+  {
+    std::ofstream file(inner_path);
+    file << "@" << inner_path;
+  }
+  EXPECT_FALSE(parser.Parse(2, const_cast<char**>(argv)));
+  EXPECT_EQ(parser.error_message(), "response file \"" + inner_path +
+                                        "\" is nested too deeply (max: 8).");
+
+  remove(inner_path.c_str());
+  EXPECT_FALSE(parser.Parse(2, const_cast<char**>(argv)));
+  EXPECT_EQ(parser.error_message(),
+            "failed to read response file \"" + inner_path + "\".");
+  remove(outer_path.c_str());
+}
+#endif
+
+}  // namespace console
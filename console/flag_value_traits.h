@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "base/strings/string_number_conversions.h"
 
 namespace console {
@@ -142,6 +143,22 @@ class FlagValueTraits<std::string> {
   }
 };
 
+// Refers to the argument instead of copying it, so the argument must outlive
+// the value.
+template <>
+class FlagValueTraits<absl::string_view> {
+ public:
+  static bool ParseValue(absl::string_view input, absl::string_view* value,
+                         std::string* reason) {
+    if (input.length() == 0) {
+      *reason = "input is empty";
+      return false;
+    }
+    *value = input;
+    return true;
+  }
+};
+
 template <typename T>
 class FlagValueTraits<std::vector<T>> {
  public:
@@ -0,0 +1,61 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/frame_cache.h"
+
+namespace console {
+
+namespace {
+
+bool IsSameInfo(const Console::Info& a, const Console::Info& b) {
+  return a.support_ansi == b.support_ansi &&
+         a.support_4bit_color == b.support_4bit_color &&
+         a.support_8bit_color == b.support_8bit_color &&
+         a.support_truecolor == b.support_truecolor;
+}
+
+}  // namespace
+
+FrameCache::FrameCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+FrameCache::~FrameCache() = default;
+
+void FrameCache::Prepare(size_t period, const Console::Info& info) {
+  if (period == period_ && IsSameInfo(info, info_)) return;
+  Clear();
+  period_ = period;
+  info_ = info;
+  slots_.resize(period);
+}
+
+void FrameCache::Clear() {
+  period_ = 0;
+  arena_.clear();
+  slots_.clear();
+}
+
+bool FrameCache::Lookup(size_t frame, absl::string_view* bytes) const {
+  if (frame >= slots_.size() || !slots_[frame].cached) return false;
+  const Slot& slot = slots_[frame];
+  *bytes = absl::string_view(arena_.data() + slot.offset, slot.size);
+  return true;
+}
+
+bool FrameCache::Store(size_t frame, absl::string_view bytes) {
+  if (frame >= slots_.size()) return false;
+  if (slots_[frame].cached) return true;
+  if (arena_.size() + bytes.size() > max_bytes_) return false;
+  Slot& slot = slots_[frame];
+  slot.offset = arena_.size();
+  slot.size = bytes.size();
+  slot.cached = true;
+  arena_.append(bytes.data(), bytes.size());
+  return true;
+}
+
+size_t FrameCache::period() const { return period_; }
+
+size_t FrameCache::size() const { return arena_.size(); }
+
+}  // namespace console
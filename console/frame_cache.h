@@ -0,0 +1,66 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_FRAME_CACHE_H_
+#define CONSOLE_FRAME_CACHE_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "console/console.h"
+#include "console/export.h"
+
+namespace console {
+
+// FrameCache keeps the bytes of every frame of a periodic animation, so that
+// they are drawn once and replayed afterwards. The frames are stored back to
+// back in a single arena. Once the arena would exceed |max_bytes|, the rest of
+// the frames are not cached.
+//
+// The bytes depend on the console capabilities, so the cache is dropped when
+// they change, for example by AdaptiveQualityController.
+class CONSOLE_EXPORT FrameCache {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 1 << 20;
+
+  explicit FrameCache(size_t max_bytes = kDefaultMaxBytes);
+  FrameCache(const FrameCache& other) = delete;
+  FrameCache& operator=(const FrameCache& other) = delete;
+  ~FrameCache();
+
+  // Drops every frame if |period| or |info| is different from what the
+  // frames were cached with.
+  void Prepare(size_t period, const Console::Info& info);
+  void Clear();
+
+  // Returns true and sets |bytes| if |frame| is cached. |bytes| is valid
+  // until the next call to Store() or Clear().
+  bool Lookup(size_t frame, absl::string_view* bytes) const;
+  // Returns false if |bytes| doesn't fit within |max_bytes|.
+  bool Store(size_t frame, absl::string_view bytes);
+
+  size_t period() const;
+  // Returns the number of bytes stored in the arena.
+  size_t size() const;
+
+ private:
+  struct Slot {
+    size_t offset = 0;
+    size_t size = 0;
+    bool cached = false;
+  };
+
+  size_t max_bytes_;
+  size_t period_ = 0;
+  Console::Info info_;
+  std::string arena_;
+  std::vector<Slot> slots_;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_FRAME_CACHE_H_
@@ -0,0 +1,102 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/frame_cache.h"
+
+#include "color/named_color.h"
+#include "console/animation.h"
+#include "console/sgr_parameters.h"
+#include "gtest/gtest.h"
+
+namespace console {
+
+namespace {
+
+class PeriodicAnimation : public Animation {
+ public:
+  PeriodicAnimation(size_t period, size_t* count)
+      : period_(period), count_(count) {}
+
+ private:
+  bool ShouldUpdate() override { return true; }
+
+  void DoUpdate(RenderContext* context) override {
+    (*count_)++;
+    context->stream().Write(std::to_string(current_frame_ % period_));
+  }
+
+  size_t GetPeriod() const override { return period_; }
+
+  size_t period_;
+  size_t* count_;
+};
+
+}  // namespace
+
+TEST(FrameCacheTest, StoreAndLookup) {
+  Console::Info info;
+  FrameCache cache(8);
+  cache.Prepare(3, info);
+  absl::string_view bytes;
+  EXPECT_FALSE(cache.Lookup(0, &bytes));
+  EXPECT_TRUE(cache.Store(0, "abcd"));
+  EXPECT_TRUE(cache.Store(1, "efgh"));
+  // Exceeds the cap.
+  EXPECT_FALSE(cache.Store(2, "i"));
+  EXPECT_FALSE(cache.Store(3, "i"));
+  EXPECT_TRUE(cache.Lookup(1, &bytes));
+  EXPECT_EQ(bytes, "efgh");
+  EXPECT_EQ(cache.size(), 8);
+
+  // The same period and info keep the frames.
+  cache.Prepare(3, info);
+  EXPECT_TRUE(cache.Lookup(0, &bytes));
+  info.support_truecolor = !info.support_truecolor;
+  cache.Prepare(3, info);
+  EXPECT_FALSE(cache.Lookup(0, &bytes));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(FrameCacheTest, Replay) {
+  size_t count = 0;
+  PeriodicAnimation animation(3, &count);
+  animation.set_repeat(true);
+  animation.EnableFrameCache();
+
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  for (size_t i = 0; i < 7; ++i) animation.Update(&context);
+  EXPECT_EQ(count, 3);
+
+  std::string reset(kReset);
+  std::string expected;
+  for (size_t i = 0; i < 7; ++i) expected += std::to_string(i % 3) + reset;
+  EXPECT_EQ(target.buffer(), expected);
+}
+
+TEST(FrameCacheTest, SameOutput) {
+  auto render = [](bool cached, bool change_colors) {
+    NeonTextAnimation animation;
+    animation.set_text("Hello World\n");
+    animation.set_colors({color::kBlack, color::kGray, color::kWhite});
+    animation.set_repeat(true);
+    if (cached) animation.EnableFrameCache();
+
+    BufferRenderTarget target;
+    RenderContext context(&target);
+    for (size_t i = 0; i < 10; ++i) {
+      if (change_colors && i == 5) {
+        animation.set_colors({color::kRed, color::kBlue});
+      }
+      animation.Update(&context);
+    }
+    return target.buffer();
+  };
+
+  EXPECT_EQ(render(true, false), render(false, false));
+  // set_colors() invalidates the cache.
+  EXPECT_EQ(render(true, true), render(false, true));
+}
+
+}  // namespace console
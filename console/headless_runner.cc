@@ -0,0 +1,53 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/headless_runner.h"
+
+namespace console {
+
+double HeadlessRunner::Result::GetTicksPerSecond() const {
+  if (elapsed.count() == 0) return 0;
+  return ticks / std::chrono::duration<double>(elapsed).count();
+}
+
+HeadlessRunner::HeadlessRunner(RenderTarget* target)
+    : scheduler_(target ? target : &null_target_),
+      next_(AnimationScheduler::Clock::time_point::max()) {
+  scheduler_.set_tick_clock(&clock_);
+}
+
+HeadlessRunner::~HeadlessRunner() = default;
+
+void HeadlessRunner::AddAnimation(std::unique_ptr<Animation> animation,
+                                  std::chrono::milliseconds interval) {
+  scheduler_.AddAnimation(std::move(animation), interval);
+  // The first frame of the new animation is due at the next tick.
+  next_ = clock_.NowTicks();
+}
+
+HeadlessRunner::Result HeadlessRunner::Run(size_t max_ticks) {
+  Result result;
+  TickClock::TimePoint start = clock_.NowTicks();
+  auto real_start = std::chrono::steady_clock::now();
+  while (result.ticks < max_ticks &&
+         next_ != AnimationScheduler::Clock::time_point::max()) {
+    if (next_ > clock_.NowTicks()) clock_.SetNowTicks(next_);
+    next_ = scheduler_.Tick(clock_.NowTicks());
+    result.ticks++;
+  }
+  result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - real_start);
+  result.virtual_time = clock_.NowTicks() - start;
+  return result;
+}
+
+VirtualTickClock* HeadlessRunner::clock() { return &clock_; }
+
+AnimationScheduler* HeadlessRunner::scheduler() { return &scheduler_; }
+
+size_t HeadlessRunner::bytes_discarded() const {
+  return null_target_.bytes_written();
+}
+
+}  // namespace console
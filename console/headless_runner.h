@@ -0,0 +1,71 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_HEADLESS_RUNNER_H_
+#define CONSOLE_HEADLESS_RUNNER_H_
+
+#include <stddef.h>
+
+#include <chrono>
+#include <memory>
+
+#include "console/animation.h"
+#include "console/animation_scheduler.h"
+#include "console/export.h"
+#include "console/render_target.h"
+#include "console/tick_clock.h"
+
+namespace console {
+
+// HeadlessRunner steps animations as fast as possible on a VirtualTickClock.
+// Instead of sleeping until the next frame is due, it jumps the clock to it,
+// so frame pacing is deterministic and the real time spent is only the time
+// spent rendering.
+//
+// HeadlessRunner runner;
+// runner.AddAnimation(std::move(animation), std::chrono::milliseconds(100));
+// HeadlessRunner::Result result = runner.Run(1000);
+// printf("%f ticks/s\n", result.GetTicksPerSecond());
+class CONSOLE_EXPORT HeadlessRunner {
+ public:
+  struct CONSOLE_EXPORT Result {
+    size_t ticks = 0;
+    // The time the virtual clock moved forward.
+    std::chrono::nanoseconds virtual_time{0};
+    // The real time Run() took.
+    std::chrono::nanoseconds elapsed{0};
+
+    // Returns the ticks rendered per second of real time.
+    double GetTicksPerSecond() const;
+  };
+
+  // Renders to |target|, which must outlive the runner. If it is null, the
+  // output is discarded.
+  explicit HeadlessRunner(RenderTarget* target = nullptr);
+  HeadlessRunner(const HeadlessRunner& other) = delete;
+  HeadlessRunner& operator=(const HeadlessRunner& other) = delete;
+  ~HeadlessRunner();
+
+  void AddAnimation(std::unique_ptr<Animation> animation,
+                    std::chrono::milliseconds interval);
+
+  // Ticks up to |max_ticks| times, moving the clock to each deadline. Returns
+  // early when every animation has ended.
+  Result Run(size_t max_ticks);
+
+  VirtualTickClock* clock();
+  AnimationScheduler* scheduler();
+  // Returns the bytes written if the output is discarded, or 0 otherwise.
+  size_t bytes_discarded() const;
+
+ private:
+  NullRenderTarget null_target_;
+  VirtualTickClock clock_;
+  AnimationScheduler scheduler_;
+  AnimationScheduler::Clock::time_point next_;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_HEADLESS_RUNNER_H_
@@ -0,0 +1,93 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/headless_runner.h"
+
+#include <vector>
+
+#include "console/progress_board.h"
+#include "gtest/gtest.h"
+
+namespace console {
+
+namespace {
+
+class TimestampAnimation : public Animation {
+ public:
+  TimestampAnimation(std::vector<TickClock::TimePoint>* timestamps,
+                     size_t total_frames)
+      : timestamps_(timestamps), total_frames_(total_frames) {}
+
+ private:
+  bool ShouldUpdate() override { return true; }
+
+  void DoUpdate(RenderContext* context) override {
+    timestamps_->push_back(context->tick_clock()->NowTicks());
+    context->stream().Write('.');
+    if (current_frame_ + 1 == total_frames_) ended_ = true;
+  }
+
+  std::vector<TickClock::TimePoint>* timestamps_;
+  size_t total_frames_;
+};
+
+}  // namespace
+
+TEST(VirtualTickClockTest, Advance) {
+  VirtualTickClock clock;
+  EXPECT_EQ(clock.NowTicks(), TickClock::TimePoint());
+  clock.Advance(std::chrono::milliseconds(5));
+  EXPECT_EQ(clock.NowTicks(),
+            TickClock::TimePoint() + std::chrono::milliseconds(5));
+  clock.SetNowTicks(TickClock::TimePoint());
+  EXPECT_EQ(clock.NowTicks(), TickClock::TimePoint());
+}
+
+TEST(HeadlessRunnerTest, Run) {
+  std::vector<TickClock::TimePoint> fast, slow;
+  HeadlessRunner runner;
+  runner.AddAnimation(
+      std::unique_ptr<Animation>(new TimestampAnimation(&fast, 6)),
+      std::chrono::milliseconds(10));
+  runner.AddAnimation(
+      std::unique_ptr<Animation>(new TimestampAnimation(&slow, 3)),
+      std::chrono::milliseconds(30));
+
+  HeadlessRunner::Result result = runner.Run(3);
+  EXPECT_EQ(result.ticks, 3u);
+  EXPECT_EQ(result.virtual_time, std::chrono::milliseconds(20));
+
+  result = runner.Run(100);
+  // The animations end at 50ms and 60ms.
+  EXPECT_EQ(result.ticks, 4u);
+  EXPECT_GE(runner.bytes_discarded(), fast.size() + slow.size());
+  ASSERT_EQ(fast.size(), 6u);
+  ASSERT_EQ(slow.size(), 3u);
+  for (size_t i = 0; i < fast.size(); ++i) {
+    EXPECT_EQ(fast[i] - fast[0], std::chrono::milliseconds(10 * i));
+  }
+  for (size_t i = 0; i < slow.size(); ++i) {
+    EXPECT_EQ(slow[i] - slow[0], std::chrono::milliseconds(30 * i));
+  }
+  EXPECT_TRUE(runner.scheduler()->empty());
+}
+
+TEST(HeadlessRunnerTest, ProgressBoard) {
+  std::unique_ptr<ProgressBoard> board(new ProgressBoard());
+  ProgressBoard::Task* task = board->AddTask("task", 100);
+  HeadlessRunner runner;
+  runner.AddAnimation(std::move(board), std::chrono::milliseconds(100));
+
+  runner.Run(1);
+  for (int i = 0; i < 5; ++i) {
+    task->Increment(10);
+    runner.Run(1);
+    EXPECT_DOUBLE_EQ(task->rate(), 100);
+  }
+  std::chrono::seconds eta;
+  ASSERT_TRUE(task->GetEta(&eta));
+  EXPECT_EQ(eta.count(), 1);
+}
+
+}  // namespace console
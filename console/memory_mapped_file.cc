@@ -0,0 +1,113 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/memory_mapped_file.h"
+
+#include "console/console.h"
+
+#if defined(OS_WIN)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace console {
+
+MemoryMappedFile::MemoryMappedFile() = default;
+
+MemoryMappedFile::~MemoryMappedFile() { Close(); }
+
+#if defined(OS_WIN)
+
+bool MemoryMappedFile::Initialize(const std::string& path) {
+  Close();
+  HANDLE file = CreateFileA(
+      path.c_str(), GENERIC_READ,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size;
+  if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+  // CreateFileMapping() fails for an empty file.
+  if (size.QuadPart > 0) {
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+      CloseHandle(file);
+      return false;
+    }
+    void* memory = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // The view keeps the mapping open.
+    CloseHandle(mapping);
+    if (!memory) {
+      CloseHandle(file);
+      return false;
+    }
+    memory_ = memory;
+    length_ = static_cast<size_t>(size.QuadPart);
+  }
+  CloseHandle(file);
+  valid_ = true;
+  return true;
+}
+
+void MemoryMappedFile::Close() {
+  if (memory_) UnmapViewOfFile(memory_);
+  memory_ = nullptr;
+  length_ = 0;
+  valid_ = false;
+}
+
+#else
+
+bool MemoryMappedFile::Initialize(const std::string& path) {
+  Close();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return false;
+  }
+  // mmap() fails for an empty file.
+  if (st.st_size > 0) {
+    void* memory = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (memory == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+    memory_ = memory;
+    length_ = st.st_size;
+    // The file is read from the front to the back.
+    madvise(memory_, length_, MADV_SEQUENTIAL);
+  }
+  close(fd);
+  valid_ = true;
+  return true;
+}
+
+void MemoryMappedFile::Close() {
+  if (memory_) munmap(memory_, length_);
+  memory_ = nullptr;
+  length_ = 0;
+  valid_ = false;
+}
+
+#endif  // defined(OS_WIN)
+
+bool MemoryMappedFile::IsValid() const { return valid_; }
+
+absl::string_view MemoryMappedFile::data() const {
+  return absl::string_view(static_cast<const char*>(memory_), length_);
+}
+
+}  // namespace console
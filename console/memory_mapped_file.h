@@ -0,0 +1,49 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_MEMORY_MAPPED_FILE_H_
+#define CONSOLE_MEMORY_MAPPED_FILE_H_
+
+#include <stddef.h>
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "console/export.h"
+
+namespace console {
+
+// MemoryMappedFile maps a whole file read only, so that it can be read as a
+// string without copying it into memory. Pages are loaded on demand and can
+// be dropped by the OS again, so reading a large file several times keeps
+// the memory usage of the process constant. On Windows, the file can't be
+// truncated while it is mapped.
+//
+// MemoryMappedFile file;
+// if (file.Initialize("rows.tsv")) Parse(file.data());
+class CONSOLE_EXPORT MemoryMappedFile {
+ public:
+  MemoryMappedFile();
+  MemoryMappedFile(const MemoryMappedFile& other) = delete;
+  MemoryMappedFile& operator=(const MemoryMappedFile& other) = delete;
+  ~MemoryMappedFile();
+
+  // Maps the file at |path|. Returns false if it can't be opened or mapped.
+  // An empty file is mapped as empty data.
+  bool Initialize(const std::string& path);
+  bool IsValid() const;
+
+  absl::string_view data() const;
+
+ private:
+  void Close();
+
+  void* memory_ = nullptr;
+  size_t length_ = 0;
+  bool valid_ = false;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_MEMORY_MAPPED_FILE_H_
@@ -0,0 +1,201 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/metrics.h"
+
+#include <atomic>
+#include <sstream>
+
+namespace console {
+
+namespace {
+
+struct Counters {
+  std::atomic<uint64_t> bytes_written{0};
+  std::atomic<uint64_t> escapes[MetricsSnapshot::kEscapeKinds];
+  std::atomic<uint64_t> flushes{0};
+  std::atomic<uint64_t> frames_rendered{0};
+  std::atomic<uint64_t> frames_skipped{0};
+  std::atomic<uint64_t> write_blocked_ns{0};
+  std::atomic<uint64_t>
+      frame_time_histogram[MetricsSnapshot::kFrameTimeBuckets];
+
+  Counters() { Reset(); }
+
+  void Reset() {
+    bytes_written.store(0, std::memory_order_relaxed);
+    for (auto& escape : escapes) escape.store(0, std::memory_order_relaxed);
+    flushes.store(0, std::memory_order_relaxed);
+    frames_rendered.store(0, std::memory_order_relaxed);
+    frames_skipped.store(0, std::memory_order_relaxed);
+    write_blocked_ns.store(0, std::memory_order_relaxed);
+    for (auto& bucket : frame_time_histogram)
+      bucket.store(0, std::memory_order_relaxed);
+  }
+};
+
+Counters& GetCounters() {
+  static Counters* counters = new Counters();
+  return *counters;
+}
+
+size_t GetFrameTimeBucket(std::chrono::nanoseconds render_time) {
+  uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    render_time)
+                    .count();
+  size_t bucket = 0;
+  while (us > 0 && bucket < MetricsSnapshot::kFrameTimeBuckets - 1) {
+    us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+const char* EscapeKindToString(EscapeKind kind) {
+  switch (kind) {
+    case EscapeKind::kSgr:
+      return "sgr";
+    case EscapeKind::kColor4:
+      return "color4";
+    case EscapeKind::kColor8:
+      return "color8";
+    case EscapeKind::kColor24:
+      return "color24";
+    case EscapeKind::kCursor:
+      return "cursor";
+    case EscapeKind::kScroll:
+      return "scroll";
+    case EscapeKind::kTab:
+      return "tab";
+    case EscapeKind::kErase:
+      return "erase";
+    case EscapeKind::kMax:
+      break;
+  }
+  return "unknown";
+}
+
+constexpr size_t MetricsSnapshot::kFrameTimeBuckets;
+constexpr size_t MetricsSnapshot::kEscapeKinds;
+
+std::string MetricsSnapshot::ToString() const {
+  std::stringstream ss;
+  ss << "bytes_written: " << bytes_written << std::endl;
+  for (size_t i = 0; i < kEscapeKinds; ++i) {
+    ss << "escapes." << EscapeKindToString(static_cast<EscapeKind>(i)) << ": "
+       << escapes[i] << std::endl;
+  }
+  ss << "flushes: " << flushes << std::endl;
+  ss << "write_blocked_ns: " << write_blocked_ns << std::endl;
+  ss << "frames_rendered: " << frames_rendered << std::endl;
+  ss << "frames_skipped: " << frames_skipped << std::endl;
+  ss << "frame_time_us:";
+  for (size_t i = 0; i < kFrameTimeBuckets; ++i) {
+    if (frame_time_histogram[i] == 0) continue;
+    ss << " [<" << (uint64_t{1} << i) << "]=" << frame_time_histogram[i];
+  }
+  ss << std::endl;
+  return ss.str();
+}
+
+constexpr bool Metrics::kEnabled;
+
+// static
+void Metrics::RecordBytesWritten(size_t bytes) {
+  GetCounters().bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// static
+void Metrics::RecordEscape(EscapeKind kind, size_t bytes) {
+  Counters& counters = GetCounters();
+  counters.escapes[static_cast<size_t>(kind)].fetch_add(
+      1, std::memory_order_relaxed);
+  counters.bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// static
+void Metrics::RecordFlush(std::chrono::nanoseconds blocked) {
+  Counters& counters = GetCounters();
+  counters.flushes.fetch_add(1, std::memory_order_relaxed);
+  counters.write_blocked_ns.fetch_add(blocked.count(),
+                                      std::memory_order_relaxed);
+}
+
+// static
+void Metrics::RecordFrame(std::chrono::nanoseconds render_time) {
+  Counters& counters = GetCounters();
+  counters.frames_rendered.fetch_add(1, std::memory_order_relaxed);
+  counters.frame_time_histogram[GetFrameTimeBucket(render_time)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+// static
+void Metrics::RecordFrameSkipped(size_t frames) {
+  GetCounters().frames_skipped.fetch_add(frames, std::memory_order_relaxed);
+}
+
+// static
+MetricsSnapshot Metrics::Snapshot() {
+  Counters& counters = GetCounters();
+  MetricsSnapshot snapshot;
+  snapshot.bytes_written =
+      counters.bytes_written.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < MetricsSnapshot::kEscapeKinds; ++i) {
+    snapshot.escapes[i] = counters.escapes[i].load(std::memory_order_relaxed);
+  }
+  snapshot.flushes = counters.flushes.load(std::memory_order_relaxed);
+  snapshot.frames_rendered =
+      counters.frames_rendered.load(std::memory_order_relaxed);
+  snapshot.frames_skipped =
+      counters.frames_skipped.load(std::memory_order_relaxed);
+  snapshot.write_blocked_ns =
+      counters.write_blocked_ns.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < MetricsSnapshot::kFrameTimeBuckets; ++i) {
+    snapshot.frame_time_histogram[i] =
+        counters.frame_time_histogram[i].load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+// static
+void Metrics::Reset() { GetCounters().Reset(); }
+
+ScopedFrameTimer::ScopedFrameTimer()
+    : start_(std::chrono::steady_clock::now()) {}
+
+ScopedFrameTimer::~ScopedFrameTimer() {
+  Metrics::RecordFrame(std::chrono::steady_clock::now() - start_);
+}
+
+MetricsDumper::MetricsDumper() = default;
+
+MetricsDumper::~MetricsDumper() { Stop(); }
+
+void MetricsDumper::Start(std::ostream* ostream,
+                          std::chrono::milliseconds interval) {
+  Stop();
+  stopped_ = false;
+  thread_ = std::thread(&MetricsDumper::Run, this, ostream, interval);
+}
+
+void MetricsDumper::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) thread_.join();
+}
+
+void MetricsDumper::Run(std::ostream* ostream,
+                        std::chrono::milliseconds interval) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!cv_.wait_for(lock, interval, [this]() { return stopped_; })) {
+    *ostream << Metrics::Snapshot().ToString() << std::flush;
+  }
+}
+
+}  // namespace console
@@ -0,0 +1,125 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_METRICS_H_
+#define CONSOLE_METRICS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "console/export.h"
+
+// Render metrics are opt-in. Build with -DCONSOLE_ENABLE_METRICS to record
+// them, otherwise every CONSOLE_METRICS_* macro below expands to nothing and
+// the snapshot stays zeroed.
+#if defined(CONSOLE_ENABLE_METRICS)
+#define CONSOLE_METRICS(statement) statement
+#define CONSOLE_METRICS_SCOPED_FRAME_TIMER(name) \
+  ::console::ScopedFrameTimer name
+#else
+#define CONSOLE_METRICS(statement)
+#define CONSOLE_METRICS_SCOPED_FRAME_TIMER(name)
+#endif
+
+namespace console {
+
+// Kinds of escape sequences emitted by Stream.
+enum class EscapeKind {
+  kSgr,
+  kColor4,
+  kColor8,
+  kColor24,
+  kCursor,
+  kScroll,
+  kTab,
+  kErase,
+  kMax,
+};
+
+CONSOLE_EXPORT const char* EscapeKindToString(EscapeKind kind);
+
+struct CONSOLE_EXPORT MetricsSnapshot {
+  // Frame render times are bucketed by powers of two in microseconds.
+  // |frame_time_histogram[0]| counts frames under 1us, |[i]| counts frames in
+  // [2^(i-1), 2^i) us and the last bucket counts everything above.
+  static constexpr size_t kFrameTimeBuckets = 20;
+  static constexpr size_t kEscapeKinds = static_cast<size_t>(EscapeKind::kMax);
+
+  uint64_t bytes_written = 0;
+  uint64_t escapes[kEscapeKinds] = {};
+  uint64_t flushes = 0;
+  uint64_t frames_rendered = 0;
+  uint64_t frames_skipped = 0;
+  uint64_t write_blocked_ns = 0;
+  uint64_t frame_time_histogram[kFrameTimeBuckets] = {};
+
+  std::string ToString() const;
+};
+
+// Process wide counters. All of them are relaxed atomics, so recording is
+// safe from any thread and costs a single uncontended add.
+class CONSOLE_EXPORT Metrics {
+ public:
+#if defined(CONSOLE_ENABLE_METRICS)
+  static constexpr bool kEnabled = true;
+#else
+  static constexpr bool kEnabled = false;
+#endif
+
+  static void RecordBytesWritten(size_t bytes);
+  // Records an escape sequence of |bytes| length. This also counts toward
+  // bytes written.
+  static void RecordEscape(EscapeKind kind, size_t bytes);
+  // Records a flush which blocked the caller for |blocked|.
+  static void RecordFlush(std::chrono::nanoseconds blocked);
+  static void RecordFrame(std::chrono::nanoseconds render_time);
+  static void RecordFrameSkipped(size_t frames = 1);
+
+  static MetricsSnapshot Snapshot();
+  static void Reset();
+};
+
+// Measures the lifetime of the object and records it as a frame.
+class CONSOLE_EXPORT ScopedFrameTimer {
+ public:
+  ScopedFrameTimer();
+  ScopedFrameTimer(const ScopedFrameTimer& other) = delete;
+  ScopedFrameTimer& operator=(const ScopedFrameTimer& other) = delete;
+  ~ScopedFrameTimer();
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Writes Metrics::Snapshot() to |ostream| every |interval| on a background
+// thread until Stop() is called or the dumper is destroyed.
+class CONSOLE_EXPORT MetricsDumper {
+ public:
+  MetricsDumper();
+  MetricsDumper(const MetricsDumper& other) = delete;
+  MetricsDumper& operator=(const MetricsDumper& other) = delete;
+  ~MetricsDumper();
+
+  void Start(std::ostream* ostream, std::chrono::milliseconds interval);
+  void Stop();
+
+ private:
+  void Run(std::ostream* ostream, std::chrono::milliseconds interval);
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopped_ = true;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_METRICS_H_
@@ -0,0 +1,39 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/metrics.h"
+
+#include "gtest/gtest.h"
+
+namespace console {
+
+TEST(MetricsTest, Snapshot) {
+  Metrics::Reset();
+  Metrics::RecordEscape(EscapeKind::kCursor, 4);
+  Metrics::RecordEscape(EscapeKind::kColor24, 19);
+  Metrics::RecordBytesWritten(10);
+  Metrics::RecordFlush(std::chrono::nanoseconds(100));
+  Metrics::RecordFrame(std::chrono::microseconds(0));
+  Metrics::RecordFrame(std::chrono::microseconds(3));
+  Metrics::RecordFrameSkipped();
+
+  MetricsSnapshot snapshot = Metrics::Snapshot();
+  EXPECT_EQ(snapshot.bytes_written, 33);
+  EXPECT_EQ(snapshot.escapes[static_cast<size_t>(EscapeKind::kCursor)], 1);
+  EXPECT_EQ(snapshot.escapes[static_cast<size_t>(EscapeKind::kColor24)], 1);
+  EXPECT_EQ(snapshot.escapes[static_cast<size_t>(EscapeKind::kSgr)], 0);
+  EXPECT_EQ(snapshot.flushes, 1);
+  EXPECT_EQ(snapshot.write_blocked_ns, 100);
+  EXPECT_EQ(snapshot.frames_rendered, 2);
+  EXPECT_EQ(snapshot.frames_skipped, 1);
+  EXPECT_EQ(snapshot.frame_time_histogram[0], 1);
+  EXPECT_EQ(snapshot.frame_time_histogram[2], 1);
+
+  Metrics::Reset();
+  snapshot = Metrics::Snapshot();
+  EXPECT_EQ(snapshot.bytes_written, 0);
+  EXPECT_EQ(snapshot.frames_rendered, 0);
+}
+
+}  // namespace console
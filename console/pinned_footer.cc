@@ -0,0 +1,133 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/pinned_footer.h"
+
+namespace console {
+
+PinnedFooter::FooterTarget::FooterTarget(PinnedFooter* footer)
+    : ScreenBufferRenderTarget(footer->output_), footer_(footer) {}
+
+PinnedFooter::FooterTarget::~FooterTarget() = default;
+
+void PinnedFooter::FooterTarget::Flush() {
+  // While disabled, frames are written as is.
+  if (!footer_->enabled_) Invalidate();
+  ScreenBufferRenderTarget::Flush();
+}
+
+bool PinnedFooter::FooterTarget::GetWindowSize(size_t* columns,
+                                               size_t* rows) {
+  size_t screen_rows;
+  if (!footer_->output_->GetWindowSize(columns, &screen_rows)) return false;
+  *rows = footer_->rows_;
+  return true;
+}
+
+PinnedFooter::LogTarget::LogTarget(PinnedFooter* footer) : footer_(footer) {}
+
+PinnedFooter::LogTarget::~LogTarget() = default;
+
+void PinnedFooter::LogTarget::Write(const char* data, size_t size) {
+  footer_->pending_log_.append(data, size);
+}
+
+void PinnedFooter::LogTarget::Flush() { footer_->FlushLog(); }
+
+PinnedFooter::PinnedFooter(RenderTarget* output, size_t rows)
+    : output_(output),
+      context_(output),
+      rows_(rows),
+      footer_target_(this),
+      log_target_(this) {}
+
+PinnedFooter::~PinnedFooter() {
+  if (enabled_) Disable();
+}
+
+bool PinnedFooter::Enable(size_t screen_rows) {
+  if (screen_rows <= rows_) return false;
+  screen_rows_ = screen_rows;
+  size_t scroll_rows = screen_rows_ - rows_;
+
+  Stream& stream = context_.stream();
+  // Scrolls the screen up as much as needed to make room for the footer.
+  for (size_t i = 0; i < rows_; ++i) stream.Write('\n');
+  stream.ScrollScreen(1, scroll_rows);
+  // Setting the scroll region moves the cursor home.
+  stream.SetCursor(scroll_rows + 1, 1);
+  stream.EraseDown();
+  context_.Flush();
+
+  footer_target_.Invalidate();
+  enabled_ = true;
+  return true;
+}
+
+bool PinnedFooter::Enable() {
+  size_t columns;
+  size_t screen_rows;
+  if (!output_->GetWindowSize(&columns, &screen_rows)) return false;
+  return Enable(screen_rows);
+}
+
+void PinnedFooter::Disable() {
+  if (!enabled_) return;
+  enabled_ = false;
+  Stream& stream = context_.stream();
+  stream.ScrollScreen();
+  stream.SetCursor(screen_rows_, 1);
+  stream.Write('\n');
+  context_.Flush();
+  // A line without a newline is printed as is from now on.
+  FlushLog();
+}
+
+bool PinnedFooter::enabled() const { return enabled_; }
+
+RenderTarget* PinnedFooter::footer_target() { return &footer_target_; }
+
+RenderTarget* PinnedFooter::log_target() { return &log_target_; }
+
+void PinnedFooter::Log(absl::string_view text) {
+  log_target_.Write(text.data(), text.length());
+  log_target_.Flush();
+}
+
+size_t PinnedFooter::rows() const { return rows_; }
+
+size_t PinnedFooter::frames_unchanged() const {
+  return footer_target_.frames_unchanged();
+}
+
+void PinnedFooter::FlushLog() {
+  if (!enabled_) {
+    output_->Write(pending_log_.data(), pending_log_.size());
+    output_->Flush();
+    pending_log_.clear();
+    return;
+  }
+
+  size_t end = pending_log_.rfind('\n');
+  if (end == std::string::npos) return;
+
+  Stream& stream = context_.stream();
+  stream.SaveCursorAndAttributes();
+  stream.Reset();
+  stream.SetCursor(screen_rows_ - rows_, 1);
+  absl::string_view lines(pending_log_.data(), end + 1);
+  while (!lines.empty()) {
+    size_t newline = lines.find('\n');
+    // A newline at the bottom of the scroll region scrolls it up by a row,
+    // leaving the cursor on the blank row it opened.
+    stream.Write("\r\n");
+    stream.Write(lines.substr(0, newline));
+    lines.remove_prefix(newline + 1);
+  }
+  stream.RestoreCursorAndAttributes();
+  context_.Flush();
+  pending_log_.erase(0, end + 1);
+}
+
+}  // namespace console
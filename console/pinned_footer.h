@@ -0,0 +1,116 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_PINNED_FOOTER_H_
+#define CONSOLE_PINNED_FOOTER_H_
+
+#include <stddef.h>
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "console/export.h"
+#include "console/render_context.h"
+#include "console/render_target.h"
+
+namespace console {
+
+// PinnedFooter keeps animations and progress bars fixed at the bottom of the
+// screen while log lines scroll above them.
+//
+// It sets the scroll region (DECSTBM) of the terminal to the rows above the
+// footer. The terminal cursor stays in the footer, so animations draw there
+// as if it were the whole screen, and a frame is written only if it differs
+// from the previous one. To print a log line, the cursor is saved, moved to
+// the bottom of the scroll region and restored, and the terminal scrolls the
+// region by itself, so the footer is never redrawn for a log line.
+//
+// Everything has to be written through footer_target() and log_target(),
+// which share the output: anything else written to the terminal would move
+// the cursor under the animations. They are not thread safe.
+//
+// PinnedFooter footer(&output, 2);
+// footer.Enable();
+// AnimationScheduler scheduler(footer.footer_target());
+// footer.Log("Downloading...\n");
+class CONSOLE_EXPORT PinnedFooter {
+ public:
+  // |output| must outlive this. |rows| is the height of the footer.
+  PinnedFooter(RenderTarget* output, size_t rows);
+  PinnedFooter(const PinnedFooter& other) = delete;
+  PinnedFooter& operator=(const PinnedFooter& other) = delete;
+  // Disables the footer if it is enabled.
+  ~PinnedFooter();
+
+  // Makes room for the footer at the bottom of a screen of |screen_rows|
+  // rows and sets the scroll region above it. Returns false if the screen is
+  // not taller than the footer.
+  bool Enable(size_t screen_rows);
+  // Same as above, but reads the height of the screen from the output.
+  // Returns false if the output doesn't know its window size.
+  bool Enable();
+  // Restores the scroll region to the whole screen and moves the cursor
+  // below the footer.
+  void Disable();
+  bool enabled() const;
+
+  // Where the animations of the footer draw. Frames are flushed by
+  // RenderTarget::Flush(). While the footer is disabled, it writes to the
+  // output as is.
+  RenderTarget* footer_target();
+  // Where the log lines are written. Complete lines are printed above the
+  // footer on Flush(); a line without a newline yet is held back until it
+  // has one.
+  RenderTarget* log_target();
+  // Writes |text| to log_target() and flushes it.
+  void Log(absl::string_view text);
+
+  size_t rows() const;
+  // Returns the number of frames not written because they were unchanged.
+  size_t frames_unchanged() const;
+
+ private:
+  // Dedupes the frames of the footer while it is enabled.
+  class FooterTarget : public ScreenBufferRenderTarget {
+   public:
+    explicit FooterTarget(PinnedFooter* footer);
+    ~FooterTarget() override;
+
+    void Flush() override;
+    // The footer is as wide as the output and |rows_| tall.
+    bool GetWindowSize(size_t* columns, size_t* rows) override;
+
+   private:
+    PinnedFooter* footer_;
+  };
+
+  class LogTarget : public RenderTarget {
+   public:
+    explicit LogTarget(PinnedFooter* footer);
+    ~LogTarget() override;
+
+    void Write(const char* data, size_t size) override;
+    void Flush() override;
+
+   private:
+    PinnedFooter* footer_;
+  };
+
+  void FlushLog();
+
+  RenderTarget* output_;
+  // Writes the escape sequences to |output_|.
+  RenderContext context_;
+  size_t rows_;
+  size_t screen_rows_ = 0;
+  bool enabled_ = false;
+
+  FooterTarget footer_target_;
+  LogTarget log_target_;
+  std::string pending_log_;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_PINNED_FOOTER_H_
@@ -0,0 +1,101 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/pinned_footer.h"
+
+#include <string>
+
+#include "console/render_context.h"
+#include "console/render_target.h"
+#include "gtest/gtest.h"
+
+namespace console {
+
+namespace {
+
+class SizedRenderTarget : public BufferRenderTarget {
+ public:
+  bool GetWindowSize(size_t* columns, size_t* rows) override {
+    *columns = 80;
+    *rows = 5;
+    return true;
+  }
+};
+
+}  // namespace
+
+TEST(PinnedFooterTest, Enable) {
+  BufferRenderTarget output;
+  PinnedFooter footer(&output, 2);
+  EXPECT_FALSE(footer.Enable(2));
+  EXPECT_TRUE(output.buffer().empty());
+
+  ASSERT_TRUE(footer.Enable(24));
+  EXPECT_EQ(output.buffer(), "\n\n\e[1;22r\e[23;1H\e[J");
+  output.Clear();
+
+  footer.Disable();
+  EXPECT_EQ(output.buffer(), "\e[r\e[24;1H\n");
+  EXPECT_FALSE(footer.enabled());
+}
+
+TEST(PinnedFooterTest, EnableWithWindowSize) {
+  // A buffer doesn't know its window size.
+  BufferRenderTarget buffer;
+  PinnedFooter unsized(&buffer, 2);
+  EXPECT_FALSE(unsized.Enable());
+
+  SizedRenderTarget output;
+  PinnedFooter footer(&output, 2);
+  ASSERT_TRUE(footer.Enable());
+  EXPECT_EQ(output.buffer(), "\n\n\e[1;3r\e[4;1H\e[J");
+}
+
+TEST(PinnedFooterTest, Log) {
+  BufferRenderTarget output;
+  PinnedFooter footer(&output, 1);
+  ASSERT_TRUE(footer.Enable(10));
+  output.Clear();
+
+  footer.Log("first\nsecond\nthi");
+  EXPECT_EQ(output.buffer(), "\e7\e[0m\e[9;1H\r\nfirst\r\nsecond\e8");
+  output.Clear();
+
+  // The partial line is held back until it ends.
+  footer.Log("rd\n");
+  EXPECT_EQ(output.buffer(), "\e7\e[0m\e[9;1H\r\nthird\e8");
+  output.Clear();
+
+  footer.Log("partial");
+  EXPECT_TRUE(output.buffer().empty());
+  footer.Disable();
+  EXPECT_EQ(output.buffer(), "\e[r\e[10;1H\npartial");
+}
+
+TEST(PinnedFooterTest, Frames) {
+  BufferRenderTarget output;
+  PinnedFooter footer(&output, 1);
+  RenderContext context(footer.footer_target());
+  ASSERT_TRUE(footer.Enable(10));
+  output.Clear();
+
+  context.stream().Write("\r50%");
+  context.Flush();
+  EXPECT_EQ(output.buffer(), "\r50%");
+  output.Clear();
+
+  // Logging doesn't redraw the footer, and an unchanged frame isn't written.
+  footer.Log("line\n");
+  output.Clear();
+  context.stream().Write("\r50%");
+  context.Flush();
+  EXPECT_TRUE(output.buffer().empty());
+  EXPECT_EQ(footer.frames_unchanged(), 1u);
+
+  context.stream().Write("\r60%");
+  context.Flush();
+  EXPECT_EQ(output.buffer(), "\r60%");
+}
+
+}  // namespace console
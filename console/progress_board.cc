@@ -0,0 +1,253 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/progress_board.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "absl/strings/str_format.h"
+#include "console/console.h"
+
+#if defined(OS_WIN)
+#include <malloc.h>
+#endif
+
+namespace console {
+
+namespace {
+
+std::string FormatBytes(double bytes) {
+  const char* kUnits[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+  size_t unit = 0;
+  while (bytes >= 1024 && unit + 1 < sizeof(kUnits) / sizeof(kUnits[0])) {
+    bytes /= 1024;
+    unit++;
+  }
+  return absl::StrFormat("%.1f%s", bytes, kUnits[unit]);
+}
+
+std::string FormatDuration(std::chrono::seconds duration) {
+  int64_t seconds = duration.count();
+  if (seconds >= 3600) {
+    return absl::StrFormat("%d:%02d:%02d", seconds / 3600,
+                           seconds / 60 % 60, seconds % 60);
+  }
+  return absl::StrFormat("%02d:%02d", seconds / 60, seconds % 60);
+}
+
+}  // namespace
+
+// static
+void* ProgressBoard::Task::operator new(size_t size) {
+#if defined(OS_WIN)
+  void* ptr = _aligned_malloc(size, alignof(Task));
+#else
+  void* ptr = nullptr;
+  if (posix_memalign(&ptr, alignof(Task), size) != 0) ptr = nullptr;
+#endif
+  // Like the global new without exceptions, running out of memory is fatal.
+  if (!ptr) abort();
+  return ptr;
+}
+
+// static
+void ProgressBoard::Task::operator delete(void* ptr) {
+#if defined(OS_WIN)
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+void ProgressBoard::Task::Increment(uint64_t n) {
+  done_.fetch_add(n, std::memory_order_relaxed);
+}
+
+void ProgressBoard::Task::AddBytes(uint64_t bytes) {
+  bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void ProgressBoard::Task::set_total(uint64_t total) {
+  total_.store(total, std::memory_order_relaxed);
+}
+
+const std::string& ProgressBoard::Task::name() const { return name_; }
+
+uint64_t ProgressBoard::Task::done() const {
+  return done_.load(std::memory_order_relaxed);
+}
+
+uint64_t ProgressBoard::Task::total() const {
+  return total_.load(std::memory_order_relaxed);
+}
+
+uint64_t ProgressBoard::Task::bytes() const {
+  return bytes_.load(std::memory_order_relaxed);
+}
+
+bool ProgressBoard::Task::IsDone() const {
+  uint64_t total = this->total();
+  return total > 0 && done() >= total;
+}
+
+bool ProgressBoard::Task::IsSampledDone() const {
+  uint64_t total = this->total();
+  return total > 0 && last_done_ >= total;
+}
+
+double ProgressBoard::Task::rate() const { return rate_; }
+
+double ProgressBoard::Task::byte_rate() const { return byte_rate_; }
+
+bool ProgressBoard::Task::GetEta(std::chrono::seconds* eta) const {
+  if (!has_rate_ || rate_ <= 0) return false;
+  uint64_t done = last_done_;
+  uint64_t total = this->total();
+  uint64_t remaining = total > done ? total - done : 0;
+  *eta = std::chrono::seconds(static_cast<int64_t>(remaining / rate_ + 0.5));
+  return true;
+}
+
+ProgressBoard::ProgressBoard() = default;
+
+ProgressBoard::~ProgressBoard() = default;
+
+ProgressBoard::Task* ProgressBoard::AddTask(const std::string& name,
+                                            uint64_t total) {
+  std::unique_ptr<Task> task(new Task());
+  task->name_ = name;
+  task->set_total(total);
+  Task* ret = task.get();
+  std::lock_guard<std::mutex> lock(mutex_);
+  tasks_.push_back(std::move(task));
+  return ret;
+}
+
+void ProgressBoard::set_smoothing(double smoothing) { smoothing_ = smoothing; }
+
+void ProgressBoard::set_bar_width(size_t bar_width) { bar_width_ = bar_width; }
+
+void ProgressBoard::set_shared_table(const SharedProgressTable* table) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  shared_table_ = table;
+  shared_tasks_.clear();
+}
+
+void ProgressBoard::Sample(Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (shared_table_) SyncSharedTable();
+  double elapsed = std::chrono::duration<double>(now - last_sample_).count();
+  bool has_elapsed = has_sampled_ && elapsed > 0;
+  for (auto& task : tasks_) {
+    uint64_t done = task->done();
+    uint64_t bytes = task->bytes();
+    if (has_elapsed) {
+      double rate = (done - task->last_done_) / elapsed;
+      double byte_rate = (bytes - task->last_bytes_) / elapsed;
+      if (task->has_rate_) {
+        task->rate_ += smoothing_ * (rate - task->rate_);
+        task->byte_rate_ += smoothing_ * (byte_rate - task->byte_rate_);
+      } else {
+        task->rate_ = rate;
+        task->byte_rate_ = byte_rate;
+        task->has_rate_ = true;
+      }
+    }
+    task->last_done_ = done;
+    task->last_bytes_ = bytes;
+  }
+  if (!has_sampled_ || has_elapsed) last_sample_ = now;
+  has_sampled_ = true;
+}
+
+void ProgressBoard::DrawTask(const Task& task, size_t name_width,
+                             Stream* stream) const {
+  uint64_t done = task.last_done_;
+  uint64_t total = task.total();
+  double ratio = total > 0 ? std::min(1.0, static_cast<double>(done) / total)
+                           : 0;
+  size_t filled = static_cast<size_t>(ratio * bar_width_);
+
+  std::string line =
+      absl::StrFormat("%-*s [", static_cast<int>(name_width), task.name());
+  line.append(filled, '=');
+  if (filled < bar_width_) {
+    line.push_back('>');
+    line.append(bar_width_ - filled - 1, ' ');
+  }
+  absl::StrAppendFormat(&line, "] %3d%% %d/%d %.1f/s",
+                        static_cast<int>(ratio * 100), done, total,
+                        task.rate());
+  if (task.bytes() > 0) {
+    absl::StrAppendFormat(&line, " %s/s", FormatBytes(task.byte_rate()));
+  }
+  std::chrono::seconds eta;
+  if (task.IsSampledDone()) {
+    line.append(" done");
+  } else if (task.GetEta(&eta)) {
+    absl::StrAppendFormat(&line, " ETA %s", FormatDuration(eta));
+  } else {
+    line.append(" ETA --:--");
+  }
+  stream->Write(line);
+}
+
+bool ProgressBoard::ShouldUpdate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !tasks_.empty() || (shared_table_ && shared_table_->size() > 0);
+}
+
+void ProgressBoard::DoUpdate(RenderContext* context) {
+  Sample(context->tick_clock()->NowTicks());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stream& stream = context->stream();
+  if (lines_drawn_ > 0) stream.CursorUp(lines_drawn_);
+
+  size_t name_width = 0;
+  for (auto& task : tasks_) {
+    name_width = std::max(name_width, task->name().length());
+  }
+
+  bool all_done = true;
+  for (auto& task : tasks_) {
+    stream.Write('\r');
+    DrawTask(*task, name_width, &stream);
+    stream.EraseEndOfLine();
+    stream.Write('\n');
+    all_done &= task->IsSampledDone();
+  }
+  lines_drawn_ = tasks_.size();
+  // A slot claimed by a worker which hasn't finished registering has no task
+  // yet, but its work isn't done either.
+  for (Task* task : shared_tasks_) {
+    if (!task) all_done = false;
+  }
+
+  if (!repeat_ && all_done) ended_ = true;
+}
+
+void ProgressBoard::SyncSharedTable() {
+  size_t size = shared_table_->size();
+  if (shared_tasks_.size() < size) shared_tasks_.resize(size, nullptr);
+  for (size_t i = 0; i < size; ++i) {
+    const SharedProgressTable::Slot& slot = shared_table_->slot(i);
+    Task* task = shared_tasks_[i];
+    if (!task) {
+      if (!slot.registered()) continue;
+      std::unique_ptr<Task> new_task(new Task());
+      new_task->name_ = slot.name();
+      task = new_task.get();
+      tasks_.push_back(std::move(new_task));
+      shared_tasks_[i] = task;
+    }
+    task->done_.store(slot.done(), std::memory_order_relaxed);
+    task->total_.store(slot.total(), std::memory_order_relaxed);
+    task->bytes_.store(slot.bytes(), std::memory_order_relaxed);
+  }
+}
+
+}  // namespace console
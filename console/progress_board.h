@@ -0,0 +1,137 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_PROGRESS_BOARD_H_
+#define CONSOLE_PROGRESS_BOARD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "console/animation.h"
+#include "console/export.h"
+#include "console/shared_progress_table.h"
+
+namespace console {
+
+// ProgressBoard draws a progress bar per task with its throughput and ETA.
+// Worker threads report progress through ProgressBoard::Task, which costs a
+// single relaxed atomic add, and the board samples the counters whenever it
+// is updated, for example by AnimationScheduler at a fixed rate.
+//
+// The throughput is smoothed with an exponentially weighted moving average
+// over the samples, and the ETA is derived from it.
+//
+// ProgressBoard board;
+// ProgressBoard::Task* task = board.AddTask("download", total);
+// // On a worker thread.
+// task->Increment();
+// task->AddBytes(n);
+//
+// The board draws over itself on every frame. It ends once every task is
+// done, unless it is set to repeat.
+class CONSOLE_EXPORT ProgressBoard : public Animation {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  class CONSOLE_EXPORT Task {
+   public:
+    // Tasks are allocated aligned to a cache line, which the global new of
+    // C++14 doesn't do for alignas(64).
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr);
+
+    // These are safe to call from any thread.
+    void Increment(uint64_t n = 1);
+    void AddBytes(uint64_t bytes);
+    void set_total(uint64_t total);
+
+    const std::string& name() const;
+    uint64_t done() const;
+    uint64_t total() const;
+    uint64_t bytes() const;
+    bool IsDone() const;
+
+    // These are computed by ProgressBoard::Sample(). Rates are per second.
+    double rate() const;
+    double byte_rate() const;
+    // Returns false if the rate is not known yet.
+    bool GetEta(std::chrono::seconds* eta) const;
+
+   private:
+    friend class ProgressBoard;
+
+    // Same as IsDone(), but as of the last sample.
+    bool IsSampledDone() const;
+
+    // Workers bump these, so they are kept on a cache line of their own,
+    // away from the fields read only by the renderer.
+    alignas(64) std::atomic<uint64_t> done_{0};
+    std::atomic<uint64_t> total_{0};
+    std::atomic<uint64_t> bytes_{0};
+
+    alignas(64) std::string name_;
+    uint64_t last_done_ = 0;
+    uint64_t last_bytes_ = 0;
+    double rate_ = 0;
+    double byte_rate_ = 0;
+    bool has_rate_ = false;
+  };
+
+  ProgressBoard();
+  ~ProgressBoard() override;
+
+  // Adds a task to draw. The board owns it. This takes a lock, so call it
+  // up front rather than in hot loops.
+  Task* AddTask(const std::string& name, uint64_t total);
+
+  // Sets the weight of a new sample in the moving average, in (0, 1]. The
+  // default is 0.3.
+  void set_smoothing(double smoothing);
+  // Sets the number of cells of a bar. The default is 30.
+  void set_bar_width(size_t bar_width);
+
+  // Draws a task for every registered slot of |table| as well, which is
+  // useful for worker processes. The board doesn't own |table|.
+  void set_shared_table(const SharedProgressTable* table);
+
+  // Reads the counters of every task and updates their rates. Update()
+  // calls this with the time of RenderContext::tick_clock().
+  void Sample(Clock::time_point now);
+
+  // Writes the line for |task| as of the last Sample(), without a newline.
+  void DrawTask(const Task& task, size_t name_width, Stream* stream) const;
+
+ protected:
+  bool ShouldUpdate() override;
+  void DoUpdate(RenderContext* context) override;
+
+ private:
+  // Adds tasks for the newly registered slots of |shared_table_| and copies
+  // the counters of the slots into them.
+  void SyncSharedTable();
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Task>> tasks_;
+  const SharedProgressTable* shared_table_ = nullptr;
+  // The task of each slot of |shared_table_|, or nullptr if the slot isn't
+  // registered yet.
+  std::vector<Task*> shared_tasks_;
+  double smoothing_ = 0.3;
+  size_t bar_width_ = 30;
+  bool has_sampled_ = false;
+  Clock::time_point last_sample_;
+  // The number of lines drawn in the last frame.
+  size_t lines_drawn_ = 0;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_PROGRESS_BOARD_H_
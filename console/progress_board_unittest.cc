@@ -0,0 +1,85 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/progress_board.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "console/render_context.h"
+#include "console/render_target.h"
+#include "gtest/gtest.h"
+
+namespace console {
+
+TEST(ProgressBoardTest, Rate) {
+  ProgressBoard board;
+  board.set_smoothing(0.5);
+  ProgressBoard::Task* task = board.AddTask("task", 100);
+
+  ProgressBoard::Clock::time_point now;
+  board.Sample(now);
+  std::chrono::seconds eta;
+  EXPECT_FALSE(task->GetEta(&eta));
+
+  task->Increment(10);
+  board.Sample(now + std::chrono::seconds(1));
+  EXPECT_DOUBLE_EQ(task->rate(), 10);
+  ASSERT_TRUE(task->GetEta(&eta));
+  EXPECT_EQ(eta.count(), 9);
+
+  task->Increment(30);
+  board.Sample(now + std::chrono::seconds(2));
+  // 0.5 * 30 + 0.5 * 10
+  EXPECT_DOUBLE_EQ(task->rate(), 20);
+  ASSERT_TRUE(task->GetEta(&eta));
+  EXPECT_EQ(eta.count(), 3);
+}
+
+TEST(ProgressBoardTest, DrawTask) {
+  ProgressBoard board;
+  board.set_bar_width(10);
+  ProgressBoard::Task* task = board.AddTask("task", 4);
+  task->Increment(2);
+  task->AddBytes(2048);
+  board.Sample(ProgressBoard::Clock::time_point());
+
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  board.DrawTask(*task, 6, &context.stream());
+  EXPECT_EQ(target.buffer(),
+            "task   [=====>    ]  50% 2/4 0.0/s 0.0B/s ETA --:--");
+}
+
+TEST(ProgressBoardTest, Workers) {
+  ProgressBoard board;
+  std::vector<ProgressBoard::Task*> tasks;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    ProgressBoard::Task* task =
+        board.AddTask("worker " + std::to_string(i), 10000);
+    // The counters of each task are on a cache line of their own.
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(task) % 64, 0u);
+    threads.emplace_back([task]() {
+      for (int j = 0; j < 10000; ++j) task->Increment();
+    });
+    tasks.push_back(task);
+  }
+
+  for (auto& thread : threads) thread.join();
+  for (ProgressBoard::Task* task : tasks) {
+    EXPECT_EQ(task->done(), 10000u);
+    EXPECT_TRUE(task->IsDone());
+  }
+
+  bool ended = false;
+  board.set_on_animation_end([&ended]() { ended = true; });
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  board.Update(&context);
+  EXPECT_TRUE(ended);
+}
+
+}  // namespace console
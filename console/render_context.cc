@@ -0,0 +1,64 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/render_context.h"
+
+#include <iostream>
+
+namespace console {
+
+RenderContext::StreamBuf::StreamBuf(RenderTarget* target) : target_(target) {}
+
+RenderContext::StreamBuf::int_type RenderContext::StreamBuf::overflow(
+    int_type c) {
+  if (traits_type::eq_int_type(c, traits_type::eof())) {
+    return traits_type::not_eof(c);
+  }
+  char ch = traits_type::to_char_type(c);
+  target_->Write(&ch, 1);
+  return c;
+}
+
+std::streamsize RenderContext::StreamBuf::xsputn(const char* s,
+                                                 std::streamsize n) {
+  target_->Write(s, static_cast<size_t>(n));
+  return n;
+}
+
+int RenderContext::StreamBuf::sync() {
+  target_->Flush();
+  return 0;
+}
+
+RenderContext::RenderContext(RenderTarget* target)
+    : target_(target),
+      tick_clock_(DefaultTickClock::GetInstance()),
+      streambuf_(target),
+      ostream_(&streambuf_),
+      stream_(ostream_) {}
+
+RenderContext::~RenderContext() = default;
+
+// static
+RenderContext* RenderContext::GetDefault() {
+  static OstreamRenderTarget* target = new OstreamRenderTarget(std::cout);
+  static RenderContext* context = new RenderContext(target);
+  return context;
+}
+
+RenderTarget* RenderContext::target() const { return target_; }
+
+std::ostream& RenderContext::ostream() { return ostream_; }
+
+Stream& RenderContext::stream() { return stream_; }
+
+void RenderContext::set_tick_clock(const TickClock* tick_clock) {
+  tick_clock_ = tick_clock;
+}
+
+const TickClock* RenderContext::tick_clock() const { return tick_clock_; }
+
+void RenderContext::Flush() { stream_.Flush(); }
+
+}  // namespace console
@@ -0,0 +1,71 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_RENDER_CONTEXT_H_
+#define CONSOLE_RENDER_CONTEXT_H_
+
+#include <ostream>
+#include <streambuf>
+
+#include "console/export.h"
+#include "console/render_target.h"
+#include "console/tick_clock.h"
+#include "console/stream.h"
+
+namespace console {
+
+// RenderContext is what an Animation draws with. It wraps a RenderTarget with
+// a std::ostream and a Stream on top of it.
+//
+// The std::ostream doesn't buffer, so anything written through it reaches
+// the target in order. Buffering is up to the target.
+class CONSOLE_EXPORT RenderContext {
+ public:
+  // |target| must outlive the context.
+  explicit RenderContext(RenderTarget* target);
+  RenderContext(const RenderContext& other) = delete;
+  RenderContext& operator=(const RenderContext& other) = delete;
+  ~RenderContext();
+
+  // Returns the context drawing to std::cout. Animation::Update() without a
+  // context uses this.
+  static RenderContext* GetDefault();
+
+  RenderTarget* target() const;
+  std::ostream& ostream();
+  Stream& stream();
+
+  // Sets the clock animations read the time from. The default is
+  // DefaultTickClock. |tick_clock| must outlive the context.
+  void set_tick_clock(const TickClock* tick_clock);
+  const TickClock* tick_clock() const;
+
+  // Ends a frame. This flushes the target through Stream::Flush(), so that
+  // the time blocked is counted by Metrics and AdaptiveQualityController.
+  void Flush();
+
+ private:
+  class StreamBuf : public std::streambuf {
+   public:
+    explicit StreamBuf(RenderTarget* target);
+
+   protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+   private:
+    RenderTarget* target_;
+  };
+
+  RenderTarget* target_;
+  const TickClock* tick_clock_;
+  StreamBuf streambuf_;
+  std::ostream ostream_;
+  Stream stream_;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_RENDER_CONTEXT_H_
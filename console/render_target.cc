@@ -0,0 +1,135 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/render_target.h"
+
+#include <errno.h>
+
+#include "console/console.h"
+
+#if defined(OS_WIN)
+#include <io.h>
+#else
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace console {
+
+RenderTarget::~RenderTarget() = default;
+
+void RenderTarget::Flush() {}
+
+bool RenderTarget::GetWindowSize(size_t* columns, size_t* rows) {
+  return false;
+}
+
+OstreamRenderTarget::OstreamRenderTarget(std::ostream& ostream)
+    : ostream_(ostream) {}
+
+OstreamRenderTarget::~OstreamRenderTarget() = default;
+
+void OstreamRenderTarget::Write(const char* data, size_t size) {
+  ostream_.write(data, size);
+}
+
+void OstreamRenderTarget::Flush() { ostream_.flush(); }
+
+bool OstreamRenderTarget::GetWindowSize(size_t* columns, size_t* rows) {
+  return Console::GetWindowSize(ostream_, columns, rows);
+}
+
+BufferRenderTarget::BufferRenderTarget() = default;
+
+BufferRenderTarget::~BufferRenderTarget() = default;
+
+void BufferRenderTarget::Write(const char* data, size_t size) {
+  buffer_.append(data, size);
+}
+
+const std::string& BufferRenderTarget::buffer() const { return buffer_; }
+
+void BufferRenderTarget::Clear() { buffer_.clear(); }
+
+NullRenderTarget::NullRenderTarget() = default;
+
+NullRenderTarget::~NullRenderTarget() = default;
+
+void NullRenderTarget::Write(const char* data, size_t size) {
+  bytes_written_ += size;
+}
+
+size_t NullRenderTarget::bytes_written() const { return bytes_written_; }
+
+ScreenBufferRenderTarget::ScreenBufferRenderTarget(RenderTarget* output)
+    : output_(output) {}
+
+ScreenBufferRenderTarget::~ScreenBufferRenderTarget() = default;
+
+void ScreenBufferRenderTarget::Write(const char* data, size_t size) {
+  back_.append(data, size);
+}
+
+void ScreenBufferRenderTarget::Flush() {
+  if (back_.empty()) return;
+  if (back_ == front_) {
+    frames_unchanged_++;
+  } else {
+    output_->Write(back_.data(), back_.size());
+    output_->Flush();
+    front_.swap(back_);
+  }
+  back_.clear();
+}
+
+bool ScreenBufferRenderTarget::GetWindowSize(size_t* columns, size_t* rows) {
+  return output_->GetWindowSize(columns, rows);
+}
+
+void ScreenBufferRenderTarget::Invalidate() { front_.clear(); }
+
+size_t ScreenBufferRenderTarget::frames_unchanged() const {
+  return frames_unchanged_;
+}
+
+FdRenderTarget::FdRenderTarget(int fd) : fd_(fd) {}
+
+FdRenderTarget::~FdRenderTarget() { Flush(); }
+
+void FdRenderTarget::Write(const char* data, size_t size) {
+  buffer_.append(data, size);
+}
+
+void FdRenderTarget::Flush() {
+  size_t offset = 0;
+  while (offset < buffer_.size()) {
+#if defined(OS_WIN)
+    int written = _write(fd_, buffer_.data() + offset,
+                         static_cast<unsigned int>(buffer_.size() - offset));
+#else
+    ssize_t written =
+        write(fd_, buffer_.data() + offset, buffer_.size() - offset);
+#endif
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    offset += written;
+  }
+  buffer_.clear();
+}
+
+bool FdRenderTarget::GetWindowSize(size_t* columns, size_t* rows) {
+#if defined(OS_WIN)
+  return false;
+#else
+  winsize size;
+  if (ioctl(fd_, TIOCGWINSZ, &size) != 0 || size.ws_col == 0) return false;
+  *columns = size.ws_col;
+  *rows = size.ws_row;
+  return true;
+#endif
+}
+
+}  // namespace console
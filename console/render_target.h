@@ -0,0 +1,124 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_RENDER_TARGET_H_
+#define CONSOLE_RENDER_TARGET_H_
+
+#include <stddef.h>
+
+#include <ostream>
+#include <string>
+
+#include "console/export.h"
+
+namespace console {
+
+// RenderTarget is where a RenderContext sends the bytes of a frame. Flush()
+// is called once the frame is complete.
+class CONSOLE_EXPORT RenderTarget {
+ public:
+  virtual ~RenderTarget();
+
+  virtual void Write(const char* data, size_t size) = 0;
+  virtual void Flush();
+  // Gets the size of the terminal behind the target. Returns false if it
+  // isn't a terminal, which is the default.
+  virtual bool GetWindowSize(size_t* columns, size_t* rows);
+};
+
+// Forwards everything to a std::ostream.
+class CONSOLE_EXPORT OstreamRenderTarget : public RenderTarget {
+ public:
+  explicit OstreamRenderTarget(std::ostream& ostream);
+  ~OstreamRenderTarget() override;
+
+  void Write(const char* data, size_t size) override;
+  void Flush() override;
+  // Supports std::cout and std::cerr, like Console::GetWindowSize().
+  bool GetWindowSize(size_t* columns, size_t* rows) override;
+
+ private:
+  std::ostream& ostream_;
+};
+
+// Keeps everything in memory.
+class CONSOLE_EXPORT BufferRenderTarget : public RenderTarget {
+ public:
+  BufferRenderTarget();
+  ~BufferRenderTarget() override;
+
+  void Write(const char* data, size_t size) override;
+
+  const std::string& buffer() const;
+  // Empties the buffer, keeping its capacity.
+  void Clear();
+
+ private:
+  std::string buffer_;
+};
+
+// NullRenderTarget discards what is written and only counts the bytes, for
+// benchmarks and tests which don't look at the output.
+class CONSOLE_EXPORT NullRenderTarget : public RenderTarget {
+ public:
+  NullRenderTarget();
+  ~NullRenderTarget() override;
+
+  void Write(const char* data, size_t size) override;
+
+  size_t bytes_written() const;
+
+ private:
+  size_t bytes_written_ = 0;
+};
+
+// Collects a frame off screen and presents it to |output| with a single
+// write on Flush(). If the frame is the same as the previous one, nothing is
+// written. This suits animations that redraw the whole frame from the same
+// cursor position every time.
+class CONSOLE_EXPORT ScreenBufferRenderTarget : public RenderTarget {
+ public:
+  // |output| must outlive this.
+  explicit ScreenBufferRenderTarget(RenderTarget* output);
+  ~ScreenBufferRenderTarget() override;
+
+  void Write(const char* data, size_t size) override;
+  void Flush() override;
+  // Returns the size of |output|.
+  bool GetWindowSize(size_t* columns, size_t* rows) override;
+
+  // Forgets the frame on screen, so the next frame is written even if it is
+  // the same. Call it when something else has drawn over the frame.
+  void Invalidate();
+  // Returns the number of frames not written because they were unchanged.
+  size_t frames_unchanged() const;
+
+ private:
+  RenderTarget* output_;
+  std::string front_;
+  std::string back_;
+  size_t frames_unchanged_ = 0;
+};
+
+// Writes to a file descriptor, such as a pty, without going through
+// std::ostream. A frame is buffered and written on Flush().
+class CONSOLE_EXPORT FdRenderTarget : public RenderTarget {
+ public:
+  // The caller keeps the ownership of |fd|.
+  explicit FdRenderTarget(int fd);
+  ~FdRenderTarget() override;
+
+  void Write(const char* data, size_t size) override;
+  void Flush() override;
+  // It is not supported on Windows.
+  bool GetWindowSize(size_t* columns, size_t* rows) override;
+
+ private:
+  int fd_;
+  std::string buffer_;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_RENDER_TARGET_H_
@@ -0,0 +1,74 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/render_target.h"
+
+#include <unistd.h>
+
+#include <sstream>
+
+#include "console/render_context.h"
+#include "gtest/gtest.h"
+
+namespace console {
+
+TEST(RenderContextTest, Write) {
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  context.ostream() << "a" << 1;
+  context.stream().Write("b").Write('c');
+  EXPECT_EQ(target.buffer(), "a1bc");
+
+  target.Clear();
+  EXPECT_TRUE(target.buffer().empty());
+}
+
+TEST(RenderContextTest, Ostream) {
+  std::stringstream ss;
+  OstreamRenderTarget target(ss);
+  RenderContext context(&target);
+  context.stream().Write("hello");
+  context.Flush();
+  EXPECT_EQ(ss.str(), "hello");
+}
+
+TEST(ScreenBufferRenderTargetTest, SkipUnchangedFrames) {
+  BufferRenderTarget output;
+  ScreenBufferRenderTarget target(&output);
+  RenderContext context(&target);
+
+  context.stream().Write("frame1");
+  EXPECT_TRUE(output.buffer().empty());
+  context.Flush();
+  EXPECT_EQ(output.buffer(), "frame1");
+
+  context.stream().Write("frame1");
+  context.Flush();
+  EXPECT_EQ(output.buffer(), "frame1");
+  EXPECT_EQ(target.frames_unchanged(), 1);
+
+  context.stream().Write("frame2");
+  context.Flush();
+  EXPECT_EQ(output.buffer(), "frame1frame2");
+}
+
+TEST(FdRenderTargetTest, Flush) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  {
+    FdRenderTarget target(fds[1]);
+    RenderContext context(&target);
+    context.stream().Write("hello");
+    context.Flush();
+  }
+  close(fds[1]);
+  char buf[16];
+  ssize_t n = read(fds[0], buf, sizeof(buf));
+  close(fds[0]);
+  // The Stream writes a reset sequence when the context is destroyed.
+  ASSERT_GE(n, 5);
+  EXPECT_EQ(std::string(buf, 5), "hello");
+}
+
+}  // namespace console
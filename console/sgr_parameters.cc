@@ -4,10 +4,111 @@
 
 #include "console/sgr_parameters.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "absl/strings/substitute.h"
 
 namespace console {
 
+namespace {
+
+// xterm's default palette.
+constexpr const uint8_t kAnsi4BitPalette[16][3] = {
+    {0, 0, 0},       {205, 0, 0},     {0, 205, 0},     {205, 205, 0},
+    {0, 0, 238},     {205, 0, 205},   {0, 205, 205},   {229, 229, 229},
+    {127, 127, 127}, {255, 0, 0},     {0, 255, 0},     {255, 255, 0},
+    {92, 92, 255},   {255, 0, 255},   {0, 255, 255},   {255, 255, 255},
+};
+
+constexpr const char* kAnsi4BitColors[16] = {
+    kBlack,      kRed,          kGreen,      kYellow,
+    kBlue,       kMagenta,      kCyan,       kWhite,
+    kLightBlack, kLightRed,     kLightGreen, kLightYellow,
+    kLightBlue,  kLightMagenta, kLightCyan,  kLightWhite,
+};
+
+constexpr const char* kBgAnsi4BitColors[16] = {
+    kBgBlack,      kBgRed,          kBgGreen,      kBgYellow,
+    kBgBlue,       kBgMagenta,      kBgCyan,       kBgWhite,
+    kBgLightBlack, kBgLightRed,     kBgLightGreen, kBgLightYellow,
+    kBgLightBlue,  kBgLightMagenta, kBgLightCyan,  kBgLightWhite,
+};
+
+// The LUT is indexed by the upper 5 bits of each channel.
+constexpr const int kAnsi4BitLutBits = 5;
+constexpr const int kAnsi4BitLutShift = 8 - kAnsi4BitLutBits;
+constexpr const int kAnsi4BitLutSize = 1 << kAnsi4BitLutBits;
+
+// 4x4 Bayer matrix for ordered dithering.
+constexpr const uint8_t kBayer4x4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+// How far a channel can be pushed by dithering. This is about the half of
+// the distance between neighboring levels of the palette.
+constexpr const int kDitherSpread = 64;
+
+uint8_t FindClosestAnsi4BitColor(int r, int g, int b) {
+  uint8_t closest = 0;
+  int min = std::numeric_limits<int>::max();
+  for (uint8_t i = 0; i < 16; ++i) {
+    int dr = r - kAnsi4BitPalette[i][0];
+    int dg = g - kAnsi4BitPalette[i][1];
+    int db = b - kAnsi4BitPalette[i][2];
+    int dist = dr * dr + dg * dg + db * db;
+    if (dist < min) {
+      closest = i;
+      min = dist;
+    }
+  }
+  return closest;
+}
+
+class Ansi4BitLut {
+ public:
+  Ansi4BitLut() {
+    // Each entry holds the closest color to the center of its cell.
+    constexpr int kHalf = 1 << (kAnsi4BitLutShift - 1);
+    for (int r = 0; r < kAnsi4BitLutSize; ++r) {
+      for (int g = 0; g < kAnsi4BitLutSize; ++g) {
+        for (int b = 0; b < kAnsi4BitLutSize; ++b) {
+          table_[Index(r, g, b)] = FindClosestAnsi4BitColor(
+              (r << kAnsi4BitLutShift) + kHalf,
+              (g << kAnsi4BitLutShift) + kHalf,
+              (b << kAnsi4BitLutShift) + kHalf);
+        }
+      }
+    }
+  }
+
+  uint8_t Get(uint8_t r, uint8_t g, uint8_t b) const {
+    return table_[Index(r >> kAnsi4BitLutShift, g >> kAnsi4BitLutShift,
+                        b >> kAnsi4BitLutShift)];
+  }
+
+ private:
+  static int Index(int r, int g, int b) {
+    return (r << (2 * kAnsi4BitLutBits)) | (g << kAnsi4BitLutBits) | b;
+  }
+
+  uint8_t table_[kAnsi4BitLutSize * kAnsi4BitLutSize * kAnsi4BitLutSize];
+};
+
+const Ansi4BitLut& GetAnsi4BitLut() {
+  static const Ansi4BitLut* lut = new Ansi4BitLut();
+  return *lut;
+}
+
+uint8_t Dither(uint8_t value, int offset) {
+  return std::min(std::max(value + offset, 0), 255);
+}
+
+}  // namespace
+
 std::string Grayscale8(uint8_t level) {
   if (level > 24) return "";
   return absl::Substitute("\e[38;5;$0m", level + 232);
@@ -34,6 +135,22 @@ std::string BgRgb24(uint8_t r, uint8_t g, uint8_t b) {
   return absl::Substitute("\e[48;2;$0;$1;$2m", r, g, b);
 }
 
+const char* Rgb4(uint8_t r, uint8_t g, uint8_t b) {
+  return kAnsi4BitColors[Ansi4BitColor(r, g, b)];
+}
+
+const char* Rgb4(uint8_t r, uint8_t g, uint8_t b, size_t x, size_t y) {
+  return kAnsi4BitColors[DitheredAnsi4BitColor(r, g, b, x, y)];
+}
+
+const char* BgRgb4(uint8_t r, uint8_t g, uint8_t b) {
+  return kBgAnsi4BitColors[Ansi4BitColor(r, g, b)];
+}
+
+const char* BgRgb4(uint8_t r, uint8_t g, uint8_t b, size_t x, size_t y) {
+  return kBgAnsi4BitColors[DitheredAnsi4BitColor(r, g, b, x, y)];
+}
+
 uint8_t Ansi8BitColor(uint8_t r, uint8_t g, uint8_t b) {
   double r_scaled = r / 255.0 * 5;
   double g_scaled = g / 255.0 * 5;
@@ -41,4 +158,15 @@ uint8_t Ansi8BitColor(uint8_t r, uint8_t g, uint8_t b) {
   return 16 + 36 * r_scaled + 6 * g_scaled + b_scaled;
 }
 
+uint8_t Ansi4BitColor(uint8_t r, uint8_t g, uint8_t b) {
+  return GetAnsi4BitLut().Get(r, g, b);
+}
+
+uint8_t DitheredAnsi4BitColor(uint8_t r, uint8_t g, uint8_t b, size_t x,
+                              size_t y) {
+  int offset = (kBayer4x4[y & 3][x & 3] * 2 - 15) * kDitherSpread / 32;
+  return Ansi4BitColor(Dither(r, offset), Dither(g, offset),
+                       Dither(b, offset));
+}
+
 }  // namespace console
\ No newline at end of file
@@ -5,6 +5,7 @@
 #ifndef CONSOLE_SGR_PARAMETERS_H_
 #define CONSOLE_SGR_PARAMETERS_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <string>
@@ -29,10 +30,29 @@ CONSOLE_EXPORT std::string BgRgb8(uint8_t r, uint8_t g, uint8_t b);
 CONSOLE_EXPORT std::string Rgb24(uint8_t r, uint8_t g, uint8_t b);
 CONSOLE_EXPORT std::string BgRgb24(uint8_t r, uint8_t g, uint8_t b);
 
+// Rgb4 and BgRgb4 gets one of the named colors, such as kRed or kLightBlue,
+// using Ansi4BitColor method. If the cell position (|x|, |y|) is given, it
+// uses DitheredAnsi4BitColor method instead.
+CONSOLE_EXPORT const char* Rgb4(uint8_t r, uint8_t g, uint8_t b);
+CONSOLE_EXPORT const char* Rgb4(uint8_t r, uint8_t g, uint8_t b, size_t x,
+                                size_t y);
+CONSOLE_EXPORT const char* BgRgb4(uint8_t r, uint8_t g, uint8_t b);
+CONSOLE_EXPORT const char* BgRgb4(uint8_t r, uint8_t g, uint8_t b, size_t x,
+                                  size_t y);
+
 // Returns Ansi 8 bit color using the equation below.
 // 6 × 6 × 6 cube (216 colors): 16 + 36 × r + 6 × g + b (0 ≤ r, g, b ≤ 5)
 CONSOLE_EXPORT uint8_t Ansi8BitColor(uint8_t r, uint8_t g, uint8_t b);
 
+// Returns the index of the closest one among the 16 ANSI colors. 0 to 7 are
+// kBlack to kWhite and 8 to 15 are kLightBlack to kLightWhite.
+// It is looked up from a table precomputed at the first call.
+CONSOLE_EXPORT uint8_t Ansi4BitColor(uint8_t r, uint8_t g, uint8_t b);
+// Same as Ansi4BitColor, but applies 4x4 ordered dithering for the cell
+// position (|x|, |y|), so that gradients look smoother.
+CONSOLE_EXPORT uint8_t DitheredAnsi4BitColor(uint8_t r, uint8_t g, uint8_t b,
+                                             size_t x, size_t y);
+
 }  // namespace console
 
 #endif  // CONSOLE_SGR_PARAMETERS_H_
\ No newline at end of file
@@ -0,0 +1,44 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/sgr_parameters.h"
+
+#include "gtest/gtest.h"
+
+namespace console {
+
+TEST(SgrParametersTest, Ansi4BitColor) {
+  EXPECT_EQ(Ansi4BitColor(0, 0, 0), 0);
+  EXPECT_EQ(Ansi4BitColor(205, 0, 0), 1);
+  EXPECT_EQ(Ansi4BitColor(0, 0, 238), 4);
+  EXPECT_EQ(Ansi4BitColor(127, 127, 127), 8);
+  EXPECT_EQ(Ansi4BitColor(92, 92, 255), 12);
+  EXPECT_EQ(Ansi4BitColor(255, 255, 255), 15);
+  EXPECT_EQ(Ansi4BitColor(250, 10, 5), 9);
+
+  EXPECT_STREQ(Rgb4(255, 0, 0), kLightRed);
+  EXPECT_STREQ(BgRgb4(0, 200, 0), kBgGreen);
+}
+
+TEST(SgrParametersTest, DitheredAnsi4BitColor) {
+  // Black is far enough from the others to be kept as it is.
+  for (size_t y = 0; y < 4; ++y) {
+    for (size_t x = 0; x < 4; ++x) {
+      EXPECT_EQ(DitheredAnsi4BitColor(0, 0, 0, x, y), 0);
+    }
+  }
+
+  // The colors between two palette colors are mixed.
+  bool has_black = false;
+  bool has_gray = false;
+  for (size_t x = 0; x < 4; ++x) {
+    uint8_t color = DitheredAnsi4BitColor(64, 64, 64, x, 0);
+    has_black |= color == 0;
+    has_gray |= color == 8;
+  }
+  EXPECT_TRUE(has_black);
+  EXPECT_TRUE(has_gray);
+}
+
+}  // namespace console
@@ -0,0 +1,203 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/shared_progress_table.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#include "console/console.h"
+
+#if !defined(OS_WIN)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace console {
+
+// The counters are shared between processes, which requires them to be
+// lock-free.
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "atomic<uint32_t> is not lock-free");
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "atomic<uint64_t> is not lock-free");
+
+constexpr size_t SharedProgressTable::kMaxNameLength;
+
+struct SharedProgressTable::Header {
+  static constexpr uint32_t kMagic = 0x50524f47;  // "PROG"
+
+  alignas(64) uint32_t magic;
+  uint32_t capacity;
+  std::atomic<uint32_t> next_slot;
+};
+
+void SharedProgressTable::Slot::Increment(uint64_t n) {
+  done_.fetch_add(n, std::memory_order_relaxed);
+}
+
+void SharedProgressTable::Slot::AddBytes(uint64_t bytes) {
+  bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void SharedProgressTable::Slot::set_total(uint64_t total) {
+  total_.store(total, std::memory_order_relaxed);
+}
+
+std::string SharedProgressTable::Slot::name() const {
+  if (!registered()) return std::string();
+  return std::string(name_, strnlen(name_, kMaxNameLength));
+}
+
+uint64_t SharedProgressTable::Slot::done() const {
+  return done_.load(std::memory_order_relaxed);
+}
+
+uint64_t SharedProgressTable::Slot::total() const {
+  return total_.load(std::memory_order_relaxed);
+}
+
+uint64_t SharedProgressTable::Slot::bytes() const {
+  return bytes_.load(std::memory_order_relaxed);
+}
+
+bool SharedProgressTable::Slot::IsDone() const {
+  uint64_t total = this->total();
+  return total > 0 && done() >= total;
+}
+
+bool SharedProgressTable::Slot::registered() const {
+  return registered_.load(std::memory_order_acquire) != 0;
+}
+
+SharedProgressTable::SharedProgressTable(const std::string& name,
+                                         void* memory, size_t length,
+                                         int owner_pid)
+    : name_(name),
+      memory_(memory),
+      length_(length),
+      header_(static_cast<Header*>(memory)),
+      owner_pid_(owner_pid) {}
+
+#if defined(OS_WIN)
+
+// static
+std::unique_ptr<SharedProgressTable> SharedProgressTable::Create(
+    const std::string& name, size_t capacity) {
+  return nullptr;
+}
+
+// static
+std::unique_ptr<SharedProgressTable> SharedProgressTable::Open(
+    const std::string& name) {
+  return nullptr;
+}
+
+SharedProgressTable::~SharedProgressTable() = default;
+
+#else
+
+// static
+std::unique_ptr<SharedProgressTable> SharedProgressTable::Create(
+    const std::string& name, size_t capacity) {
+  if (capacity == 0 || capacity > UINT32_MAX) return nullptr;
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) return nullptr;
+
+  size_t length = sizeof(Header) + capacity * sizeof(Slot);
+  void* memory = MAP_FAILED;
+  if (ftruncate(fd, length) == 0) {
+    memory =
+        mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (memory == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+
+  // ftruncate() zero fills the segment, so only the header is left to set.
+  Header* header = new (memory) Header();
+  header->capacity = static_cast<uint32_t>(capacity);
+  header->next_slot.store(0, std::memory_order_relaxed);
+  header->magic = Header::kMagic;
+  return std::unique_ptr<SharedProgressTable>(
+      new SharedProgressTable(name, memory, length, getpid()));
+}
+
+// static
+std::unique_ptr<SharedProgressTable> SharedProgressTable::Open(
+    const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) return nullptr;
+
+  struct stat st;
+  void* memory = MAP_FAILED;
+  size_t length = 0;
+  if (fstat(fd, &st) == 0 &&
+      static_cast<size_t>(st.st_size) >= sizeof(Header)) {
+    length = st.st_size;
+    memory =
+        mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (memory == MAP_FAILED) return nullptr;
+
+  const Header* header = static_cast<const Header*>(memory);
+  if (header->magic != Header::kMagic ||
+      length < sizeof(Header) + header->capacity * sizeof(Slot)) {
+    munmap(memory, length);
+    return nullptr;
+  }
+  return std::unique_ptr<SharedProgressTable>(
+      new SharedProgressTable(name, memory, length, -1));
+}
+
+SharedProgressTable::~SharedProgressTable() {
+  munmap(memory_, length_);
+  // A forked child destroying its copy of the table must not unlink it.
+  if (owner_pid_ == getpid()) shm_unlink(name_.c_str());
+}
+
+#endif  // defined(OS_WIN)
+
+SharedProgressTable::Slot* SharedProgressTable::Register(
+    const std::string& name, uint64_t total) {
+  Slot* slot = Claim();
+  if (!slot) return nullptr;
+
+  size_t length = std::min(name.length(), kMaxNameLength);
+  memcpy(slot->name_, name.data(), length);
+  slot->name_[length] = '\0';
+  slot->set_total(total);
+  // Publishes the name to the renderer.
+  slot->registered_.store(1, std::memory_order_release);
+  return slot;
+}
+
+size_t SharedProgressTable::capacity() const { return header_->capacity; }
+
+size_t SharedProgressTable::size() const {
+  return std::min<size_t>(
+      header_->next_slot.load(std::memory_order_relaxed), header_->capacity);
+}
+
+const SharedProgressTable::Slot& SharedProgressTable::slot(
+    size_t index) const {
+  return slots()[index];
+}
+
+SharedProgressTable::Slot* SharedProgressTable::slots() const {
+  return reinterpret_cast<Slot*>(static_cast<char*>(memory_) + sizeof(Header));
+}
+
+SharedProgressTable::Slot* SharedProgressTable::Claim() {
+  uint32_t index = header_->next_slot.fetch_add(1, std::memory_order_relaxed);
+  if (index >= header_->capacity) return nullptr;
+  return &slots()[index];
+}
+
+}  // namespace console
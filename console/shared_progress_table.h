@@ -0,0 +1,116 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_SHARED_PROGRESS_TABLE_H_
+#define CONSOLE_SHARED_PROGRESS_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "console/export.h"
+
+namespace console {
+
+// SharedProgressTable is a table of progress counters in a POSIX shared memory
+// segment, so that worker processes report progress to a single renderer
+// without pipes or parsing. Each worker registers a slot and bumps its
+// counters with relaxed atomic adds. ProgressBoard::set_shared_table() draws
+// the table.
+//
+// std::unique_ptr<SharedProgressTable> table =
+//     SharedProgressTable::Create("/myapp-progress", 64);
+// board->set_shared_table(table.get());
+// SharedProgressTable::Slot* slot = table->Register("worker 1", total);
+// if (fork() == 0) {
+//   // The worker inherits the mapping.
+//   slot->Increment();
+//   ...
+// }
+//
+// A worker may also register on its own, or Open() the table by name after
+// exec. Registering before the work starts keeps the board from ending while
+// a worker is still starting up. Slots are never released, so a table should
+// be created per run. It is not supported on Windows, where Create() and
+// Open() return nullptr.
+class CONSOLE_EXPORT SharedProgressTable {
+ public:
+  static constexpr size_t kMaxNameLength = 95;
+
+  // A slot lives in the shared memory, so it only holds lock-free atomics and
+  // plain bytes.
+  class CONSOLE_EXPORT Slot {
+   public:
+    // These are safe to call from any thread of any process.
+    void Increment(uint64_t n = 1);
+    void AddBytes(uint64_t bytes);
+    void set_total(uint64_t total);
+
+    // Returns the name given to Register(), truncated to kMaxNameLength.
+    std::string name() const;
+    uint64_t done() const;
+    uint64_t total() const;
+    uint64_t bytes() const;
+    bool IsDone() const;
+    // Returns false until Register() finishes writing the name.
+    bool registered() const;
+
+   private:
+    friend class SharedProgressTable;
+
+    // Slots don't share cache lines, so workers don't slow each other down.
+    alignas(64) std::atomic<uint32_t> registered_;
+    std::atomic<uint64_t> done_;
+    std::atomic<uint64_t> total_;
+    std::atomic<uint64_t> bytes_;
+    char name_[kMaxNameLength + 1];
+  };
+
+  // Creates the segment |name|, which must start with '/', and maps it. It
+  // fails if the segment already exists. The segment is unlinked when the
+  // table is destroyed by the process which created it.
+  static std::unique_ptr<SharedProgressTable> Create(const std::string& name,
+                                                     size_t capacity);
+  // Maps the existing segment |name|.
+  static std::unique_ptr<SharedProgressTable> Open(const std::string& name);
+
+  SharedProgressTable(const SharedProgressTable& other) = delete;
+  SharedProgressTable& operator=(const SharedProgressTable& other) = delete;
+  ~SharedProgressTable();
+
+  // Claims a slot. Returns nullptr if every slot is taken.
+  Slot* Register(const std::string& name, uint64_t total);
+
+  size_t capacity() const;
+  // Returns the number of claimed slots. Note that a slot may be claimed but
+  // not registered() yet.
+  size_t size() const;
+  const Slot& slot(size_t index) const;
+
+ private:
+  friend class SharedProgressTableTestPeer;
+
+  struct Header;
+
+  SharedProgressTable(const std::string& name, void* memory, size_t length,
+                      int owner_pid);
+
+  Slot* slots() const;
+  // Returns the next free slot, or nullptr if every slot is taken.
+  Slot* Claim();
+
+  std::string name_;
+  void* memory_;
+  size_t length_;
+  Header* header_;
+  // The pid of the process which created the segment, or -1 if opened.
+  int owner_pid_;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_SHARED_PROGRESS_TABLE_H_
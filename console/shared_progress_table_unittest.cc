@@ -0,0 +1,137 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/shared_progress_table.h"
+
+#include "console/console.h"
+
+#if !defined(OS_WIN)
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "absl/strings/str_cat.h"
+#include "console/progress_board.h"
+#include "console/render_context.h"
+#include "console/render_target.h"
+#include "gtest/gtest.h"
+
+namespace console {
+
+class SharedProgressTableTestPeer {
+ public:
+  static SharedProgressTable::Slot* Claim(SharedProgressTable* table) {
+    return table->Claim();
+  }
+};
+
+namespace {
+
+std::string GetTableName() {
+  return absl::StrCat("/console_unittests_", getpid());
+}
+
+}  // namespace
+
+TEST(SharedProgressTableTest, Register) {
+  std::unique_ptr<SharedProgressTable> table =
+      SharedProgressTable::Create(GetTableName(), 2);
+  ASSERT_TRUE(table);
+  // The segment exists already.
+  EXPECT_FALSE(SharedProgressTable::Create(GetTableName(), 2));
+
+  SharedProgressTable::Slot* slot = table->Register("first", 10);
+  ASSERT_TRUE(slot);
+  EXPECT_TRUE(table->Register(std::string(200, 'a'), 10));
+  EXPECT_FALSE(table->Register("third", 10));
+  EXPECT_EQ(table->size(), 2u);
+  EXPECT_EQ(table->slot(0).name(), "first");
+  EXPECT_EQ(table->slot(1).name().length(),
+            SharedProgressTable::kMaxNameLength);
+
+  std::unique_ptr<SharedProgressTable> opened =
+      SharedProgressTable::Open(GetTableName());
+  ASSERT_TRUE(opened);
+  EXPECT_EQ(opened->capacity(), 2u);
+  slot->Increment(3);
+  EXPECT_EQ(opened->slot(0).done(), 3u);
+
+  table.reset();
+  EXPECT_FALSE(SharedProgressTable::Open(GetTableName()));
+}
+
+TEST(SharedProgressTableTest, ClaimedSlot) {
+  std::unique_ptr<SharedProgressTable> table =
+      SharedProgressTable::Create(GetTableName(), 2);
+  ASSERT_TRUE(table);
+  SharedProgressTable::Slot* slot = table->Register("first", 1);
+  ASSERT_TRUE(slot);
+  slot->Increment();
+  // Claims a slot without registering it, as if its worker were still in
+  // the middle of Register().
+  ASSERT_TRUE(SharedProgressTableTestPeer::Claim(table.get()));
+
+  ProgressBoard board;
+  board.set_shared_table(table.get());
+  bool ended = false;
+  board.set_on_animation_end([&ended]() { ended = true; });
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  // The second worker is still registering, so the board goes on although
+  // every task it knows is done.
+  board.Update(&context);
+  EXPECT_FALSE(ended);
+  EXPECT_NE(target.buffer().find("first"), std::string::npos);
+}
+
+TEST(SharedProgressTableTest, Fork) {
+  std::unique_ptr<SharedProgressTable> table =
+      SharedProgressTable::Create(GetTableName(), 4);
+  ASSERT_TRUE(table);
+
+  std::vector<pid_t> pids;
+  for (int i = 0; i < 4; ++i) {
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      SharedProgressTable::Slot* slot =
+          table->Register(absl::StrCat("worker ", i), 1000);
+      for (int j = 0; j < 1000; ++j) {
+        slot->Increment();
+        slot->AddBytes(2);
+      }
+      _exit(0);
+    }
+    pids.push_back(pid);
+  }
+  for (pid_t pid : pids) {
+    int status;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+
+  // The children didn't unlink the segment.
+  EXPECT_TRUE(SharedProgressTable::Open(GetTableName()));
+
+  ProgressBoard board;
+  board.set_shared_table(table.get());
+  bool ended = false;
+  board.set_on_animation_end([&ended]() { ended = true; });
+  BufferRenderTarget target;
+  RenderContext context(&target);
+  board.Update(&context);
+  EXPECT_TRUE(ended);
+
+  ASSERT_EQ(table->size(), 4u);
+  for (size_t i = 0; i < table->size(); ++i) {
+    const SharedProgressTable::Slot& slot = table->slot(i);
+    EXPECT_TRUE(slot.IsDone());
+    EXPECT_EQ(slot.bytes(), 2000u);
+    EXPECT_NE(target.buffer().find(slot.name()), std::string::npos);
+  }
+}
+
+}  // namespace console
+
+#endif  // !defined(OS_WIN)
@@ -0,0 +1,94 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/static_flag_schema.h"
+
+#include <sstream>
+
+#include "absl/strings/str_cat.h"
+
+namespace console {
+namespace internal {
+
+namespace {
+
+// Same as the help message of FlagParser.
+constexpr const int kLineWidth = 50;
+constexpr const int kHelpStart = 20;
+
+void AppendHelp(std::stringstream& ss, const StaticFlagInfo& info) {
+  std::string names = info.name;
+  if (names.empty()) {
+    names = info.short_name;
+    if (info.short_name[0] != '\0' && info.long_name[0] != '\0') {
+      names += ", ";
+    }
+    names += info.long_name;
+  }
+  ss << names;
+  int indent = kHelpStart - static_cast<int>(names.length());
+  if (indent <= 0) {
+    ss << std::endl;
+    indent = kHelpStart;
+  }
+  ss << std::string(indent, ' ') << info.help << std::endl;
+}
+
+}  // namespace
+
+void StaticFlagNameIsInvalid() {}
+
+void StaticFlagNameIsDuplicated() {}
+
+void StaticFlagHasNoName() {}
+
+void StaticFlagPerfectHashFailed() {}
+
+std::string GetStaticFlagHelpMessage(absl::string_view program_name,
+                                     const StaticFlagInfo* infos, size_t n) {
+  std::stringstream ss;
+  ss << "Usage: " << std::endl << std::endl;
+  ss << program_name;
+  size_t flag_start = program_name.length();
+  int remain_len = kLineWidth - static_cast<int>(flag_start);
+  bool has_positional_flag = false;
+  bool has_optional_flag = false;
+  for (size_t i = 0; i < n; ++i) {
+    const StaticFlagInfo& info = infos[i];
+    if (remain_len < 0) {
+      ss << std::endl << std::string(flag_start, ' ');
+      remain_len = kLineWidth;
+    }
+    std::string usage;
+    if (info.name[0] != '\0') {
+      has_positional_flag = true;
+      usage = info.name;
+    } else {
+      has_optional_flag = true;
+      usage = absl::StrCat(
+          "[", info.short_name[0] != '\0' ? info.short_name : info.long_name,
+          "]");
+    }
+    ss << " " << usage;
+    remain_len -= static_cast<int>(usage.length()) + 1;
+  }
+  ss << std::endl;
+
+  if (has_positional_flag) {
+    ss << std::endl << "Positional arguments:" << std::endl << std::endl;
+    for (size_t i = 0; i < n; ++i) {
+      if (infos[i].name[0] != '\0') AppendHelp(ss, infos[i]);
+    }
+  }
+  if (has_optional_flag) {
+    ss << std::endl << "Optional arguments:" << std::endl << std::endl;
+    for (size_t i = 0; i < n; ++i) {
+      if (infos[i].name[0] == '\0') AppendHelp(ss, infos[i]);
+    }
+  }
+  return ss.str();
+}
+
+}  // namespace internal
+}  // namespace console
@@ -0,0 +1,561 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_STATIC_FLAG_SCHEMA_H_
+#define CONSOLE_STATIC_FLAG_SCHEMA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
+#include "console/export.h"
+#include "console/flag_value_traits.h"
+
+namespace console {
+
+// What StaticFlagSchema knows about a flag, apart from its type. The names
+// follow the rules of FlagBase: a flag is either positional with |name|, or
+// optional with |short_name|, |long_name| or both. An empty name is "".
+struct StaticFlagInfo {
+  const char* short_name;
+  const char* long_name;
+  const char* name;
+  const char* help;
+  bool required;
+  bool needs_value;
+};
+
+// A flag of StaticFlagSchema, which parses its value into the member |value|
+// of |Options|.
+template <typename Options, typename T>
+class StaticFlag {
+ public:
+  typedef Options options_type;
+  typedef T value_type;
+
+  constexpr StaticFlag(T Options::*value, const StaticFlagInfo& info)
+      : value_(value), info_(info) {}
+
+  constexpr const StaticFlagInfo& info() const { return info_; }
+
+  bool ParseValue(absl::string_view arg, Options* options,
+                  std::string* reason) const {
+    return FlagValueTraits<T>::ParseValue(arg, &(options->*value_), reason);
+  }
+
+ private:
+  T Options::*value_;
+  StaticFlagInfo info_;
+};
+
+template <typename Options, typename T>
+constexpr StaticFlag<Options, T> MakeStaticFlag(T Options::*value,
+                                                const char* short_name,
+                                                const char* long_name,
+                                                const char* help,
+                                                bool required = false) {
+  return StaticFlag<Options, T>(
+      value, {short_name, long_name, "", help, required,
+              !std::is_same<T, bool>::value});
+}
+
+// Positional flags are always required and parsed in the order they are
+// declared.
+template <typename Options, typename T>
+constexpr StaticFlag<Options, T> MakeStaticPositionalFlag(T Options::*value,
+                                                          const char* name,
+                                                          const char* help) {
+  static_assert(!std::is_same<T, bool>::value,
+                "A positional flag needs a value.");
+  return StaticFlag<Options, T>(value, {"", "", name, help, true, true});
+}
+
+namespace internal {
+
+// These are not constexpr, so calling one while a schema is evaluated at
+// compile time fails the compilation, with the name of the problem in the
+// error. A schema built at runtime ignores the problem.
+CONSOLE_EXPORT void StaticFlagNameIsInvalid();
+CONSOLE_EXPORT void StaticFlagNameIsDuplicated();
+CONSOLE_EXPORT void StaticFlagHasNoName();
+CONSOLE_EXPORT void StaticFlagPerfectHashFailed();
+
+CONSOLE_EXPORT std::string GetStaticFlagHelpMessage(
+    absl::string_view program_name, const StaticFlagInfo* infos, size_t n);
+
+constexpr size_t GetStaticFlagNameLength(const char* name) {
+  size_t length = 0;
+  while (name[length] != '\0') ++length;
+  return length;
+}
+
+// Returns true if |name| is |dashes| dashes followed by at least one
+// alphabet, digit or underscore.
+constexpr bool IsValidStaticFlagName(const char* name, size_t dashes) {
+  size_t length = GetStaticFlagNameLength(name);
+  if (length <= dashes) return false;
+  for (size_t i = 0; i < length; ++i) {
+    char c = name[i];
+    if (i < dashes) {
+      if (c != '-') return false;
+      continue;
+    }
+    if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+          (c >= '0' && c <= '9') || c == '_')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr bool StaticFlagNamesEqual(const char* a, const char* b) {
+  while (*a != '\0' && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return *a == *b;
+}
+
+// Returns the |i|th of the names of all the flags: the short name, the long
+// name and the name of each flag in turn.
+constexpr const char* GetStaticFlagName(const StaticFlagInfo* infos,
+                                        size_t i) {
+  const StaticFlagInfo& info = infos[i / 3];
+  switch (i % 3) {
+    case 0:
+      return info.short_name;
+    case 1:
+      return info.long_name;
+    default:
+      return info.name;
+  }
+}
+
+// Checks that each flag has valid names. Duplicated names are found while
+// building the hash table, see BuildStaticFlagPlan().
+constexpr bool CheckStaticFlagNames(const StaticFlagInfo* infos, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    const StaticFlagInfo& info = infos[i];
+    if (info.name[0] != '\0') {
+      if (!IsValidStaticFlagName(info.name, 0)) StaticFlagNameIsInvalid();
+      continue;
+    }
+    if (info.short_name[0] == '\0' && info.long_name[0] == '\0') {
+      StaticFlagHasNoName();
+    }
+    if (info.short_name[0] != '\0' &&
+        !IsValidStaticFlagName(info.short_name, 1)) {
+      StaticFlagNameIsInvalid();
+    }
+    if (info.long_name[0] != '\0' &&
+        !IsValidStaticFlagName(info.long_name, 2)) {
+      StaticFlagNameIsInvalid();
+    }
+  }
+  return true;
+}
+
+// FNV-1a.
+constexpr uint64_t HashStaticFlagName(const char* name, size_t length) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<uint8_t>(name[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Scrambles |hash| with |seed|, with the finalizer of SplitMix64.
+constexpr uint64_t MixStaticFlagHash(uint64_t hash, uint64_t seed) {
+  uint64_t z = hash + seed * 0x9e3779b97f4a7c15ull;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+// Returns the bucket of |hash| among |buckets|, a power of two. The high
+// bits of FNV-1a barely change with the last characters, so similar names
+// would share a bucket without scrambling the hash first, with a seed which
+// no bucket uses.
+constexpr size_t GetStaticFlagBucket(uint64_t hash, size_t buckets) {
+  return MixStaticFlagHash(hash, uint64_t{1} << 16) & (buckets - 1);
+}
+
+constexpr size_t GetNextPowerOfTwo(size_t n) {
+  size_t power = 1;
+  while (power < n) power <<= 1;
+  return power;
+}
+
+// How StaticFlagSchema parses its flags, computed at compile time.
+//
+// Every name is put in a perfect hash table built by hash and displace: a
+// name hashes to a bucket, and the seed of the bucket scrambles the hash into
+// a slot no other name takes. The key of a name is its index in
+// GetStaticFlagName(). Only the names of optional flags are looked up, the
+// others are there to find duplicates.
+template <size_t kFlags, size_t kSlots, size_t kBuckets>
+struct StaticFlagPlan {
+  uint16_t seeds[kBuckets];
+  // The key in each slot plus 1, or 0 if the slot is empty.
+  uint16_t slots[kSlots];
+  uint16_t positional_flags[kFlags];
+  size_t positional_count;
+};
+
+// Returns true if |seed| puts the names of |hashes| in slots which are
+// empty in |slots| and different from each other.
+template <size_t kSlots>
+constexpr bool CanPlaceStaticFlagNames(const uint16_t* slots,
+                                       const uint64_t* hashes, size_t count,
+                                       uint64_t seed) {
+  for (size_t i = 0; i < count; ++i) {
+    size_t slot = MixStaticFlagHash(hashes[i], seed) & (kSlots - 1);
+    if (slots[slot] != 0) return false;
+    for (size_t j = 0; j < i; ++j) {
+      if ((MixStaticFlagHash(hashes[j], seed) & (kSlots - 1)) == slot) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <size_t kFlags, size_t kSlots, size_t kBuckets>
+constexpr StaticFlagPlan<kFlags, kSlots, kBuckets> BuildStaticFlagPlan(
+    const StaticFlagInfo* infos) {
+  StaticFlagPlan<kFlags, kSlots, kBuckets> plan{};
+  CheckStaticFlagNames(infos, kFlags);
+
+  for (size_t i = 0; i < kFlags; ++i) {
+    if (infos[i].name[0] != '\0') {
+      plan.positional_flags[plan.positional_count++] =
+          static_cast<uint16_t>(i);
+    }
+  }
+
+  // Sorts the keys by bucket with a counting sort. |bucket_starts| holds
+  // where each bucket starts in |keys|.
+  constexpr size_t kKeys = 3 * kFlags;
+  uint64_t hashes[kKeys] = {};
+  size_t buckets[kKeys] = {};
+  size_t bucket_starts[kBuckets + 1] = {};
+  for (size_t key = 0; key < kKeys; ++key) {
+    const char* name = GetStaticFlagName(infos, key);
+    if (name[0] == '\0') continue;
+    hashes[key] = HashStaticFlagName(name, GetStaticFlagNameLength(name));
+    buckets[key] = GetStaticFlagBucket(hashes[key], kBuckets);
+    bucket_starts[buckets[key] + 1]++;
+  }
+  size_t max_bucket_size = 0;
+  for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+    size_t size = bucket_starts[bucket + 1];
+    if (size > max_bucket_size) max_bucket_size = size;
+    bucket_starts[bucket + 1] += bucket_starts[bucket];
+  }
+  size_t keys[kKeys] = {};
+  size_t ends[kBuckets] = {};
+  for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+    ends[bucket] = bucket_starts[bucket];
+  }
+  for (size_t key = 0; key < kKeys; ++key) {
+    if (GetStaticFlagName(infos, key)[0] == '\0') continue;
+    keys[ends[buckets[key]]++] = key;
+  }
+
+  // Places the largest buckets first, while the table is still empty, so
+  // the buckets are sorted by size the same way.
+  size_t size_starts[kKeys + 2] = {};
+  for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+    size_t size = bucket_starts[bucket + 1] - bucket_starts[bucket];
+    size_starts[max_bucket_size - size + 1]++;
+  }
+  for (size_t i = 0; i <= max_bucket_size; ++i) {
+    size_starts[i + 1] += size_starts[i];
+  }
+  size_t order[kBuckets] = {};
+  for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+    size_t size = bucket_starts[bucket + 1] - bucket_starts[bucket];
+    order[size_starts[max_bucket_size - size]++] = bucket;
+  }
+
+  uint64_t members[kKeys] = {};
+  for (size_t i = 0; i < kBuckets; ++i) {
+    size_t bucket = order[i];
+    size_t start = bucket_starts[bucket];
+    size_t end = bucket_starts[bucket + 1];
+    if (start == end) break;
+
+    // Equal names hash to the same bucket, so only the names of a bucket
+    // are compared to find duplicates. A duplicate isn't placed again.
+    size_t count = 0;
+    for (size_t j = start; j < end; ++j) {
+      const char* name = GetStaticFlagName(infos, keys[j]);
+      bool duplicated = false;
+      for (size_t k = start; k < j && !duplicated; ++k) {
+        duplicated =
+            StaticFlagNamesEqual(name, GetStaticFlagName(infos, keys[k]));
+      }
+      if (duplicated) {
+        StaticFlagNameIsDuplicated();
+        continue;
+      }
+      keys[start + count] = keys[j];
+      members[count++] = hashes[keys[j]];
+    }
+
+    uint32_t seed = 0;
+    while (seed <= UINT16_MAX &&
+           !CanPlaceStaticFlagNames<kSlots>(plan.slots, members, count,
+                                            seed)) {
+      ++seed;
+    }
+    if (seed > UINT16_MAX) {
+      StaticFlagPerfectHashFailed();
+      continue;
+    }
+    for (size_t j = 0; j < count; ++j) {
+      size_t slot = MixStaticFlagHash(members[j], seed) & (kSlots - 1);
+      plan.slots[slot] = static_cast<uint16_t>(keys[start + j] + 1);
+    }
+    plan.seeds[bucket] = static_cast<uint16_t>(seed);
+  }
+  return plan;
+}
+
+constexpr const char* GetStaticFlagDisplayName(const StaticFlagInfo& info) {
+  if (info.name[0] != '\0') return info.name;
+  if (info.long_name[0] != '\0') return info.long_name;
+  return info.short_name;
+}
+
+// Holds the flags of a schema. Each flag is a base of its own, so that the
+// depth of the instantiations doesn't grow with the number of flags, as it
+// does for std::tuple.
+template <size_t I, typename Flag>
+struct StaticFlagEntry {
+  Flag flag;
+};
+
+template <typename Indices, typename... Flags>
+struct StaticFlagStorage;
+
+template <size_t... I, typename... Flags>
+struct StaticFlagStorage<std::index_sequence<I...>, Flags...>
+    : StaticFlagEntry<I, Flags>... {
+  constexpr explicit StaticFlagStorage(const Flags&... flags)
+      : StaticFlagEntry<I, Flags>{flags}... {}
+};
+
+template <size_t I, typename Flag>
+constexpr const Flag& GetStaticFlag(const StaticFlagEntry<I, Flag>& entry) {
+  return entry.flag;
+}
+
+template <typename Flag, typename... Flags>
+struct FirstStaticFlag {
+  typedef Flag type;
+};
+
+}  // namespace internal
+
+// StaticFlagSchema declares flags as a constant table, for short-lived tools
+// where building a FlagParser at startup costs more than the parsing itself.
+// The names, types, help and required bits are known at compile time:
+//
+// - Invalid or duplicated names fail the compilation, where
+//   FlagBase::set_short_name() and the like silently ignore them.
+// - The names are looked up in a perfect hash table computed at compile
+//   time, in time proportional to the length of an argument.
+// - Parse() allocates nothing on the heap unless it fails, or a value itself
+//   does, like std::string. absl::string_view values refer to |argv|.
+//
+// struct Options {
+//   absl::string_view input;
+//   int32_t jobs = 1;
+//   bool verbose = false;
+// };
+//
+// constexpr auto kFlags = MakeStaticFlagSchema(
+//     MakeStaticPositionalFlag(&Options::input, "input", "The input"),
+//     MakeStaticFlag(&Options::jobs, "-j", "--jobs", "The number of jobs"),
+//     MakeStaticFlag(&Options::verbose, "-v", "--verbose", "Logs more"));
+//
+// Options options;
+// std::string error_message;
+// if (!kFlags.Parse(argc, argv, &options, &error_message)) ...
+template <typename Options, typename... Flags>
+class StaticFlagSchema {
+ public:
+  static constexpr size_t kFlagCount = sizeof...(Flags);
+  static_assert(kFlagCount > 0, "A schema needs a flag.");
+  static_assert(kFlagCount <= UINT16_MAX / 3, "Too many flags.");
+
+  // A flag has at most 2 names, so the hash table is at most half full, in
+  // buckets of about 2 names.
+  static constexpr size_t kSlots = internal::GetNextPowerOfTwo(4 * kFlagCount);
+  static constexpr size_t kBuckets = kSlots / 4 > 0 ? kSlots / 4 : 1;
+
+  constexpr explicit StaticFlagSchema(const Flags&... flags)
+      : flags_(flags...),
+        infos_{flags.info()...},
+        plan_(internal::BuildStaticFlagPlan<kFlagCount, kSlots, kBuckets>(
+            infos_)) {}
+
+  constexpr size_t size() const { return kFlagCount; }
+  constexpr const StaticFlagInfo& info(size_t index) const {
+    return infos_[index];
+  }
+
+  // Returns the index of the optional flag named |name|, or -1 if there is
+  // none.
+  int Find(absl::string_view name) const {
+    uint64_t hash = internal::HashStaticFlagName(name.data(), name.length());
+    size_t bucket = internal::GetStaticFlagBucket(hash, kBuckets);
+    size_t slot =
+        internal::MixStaticFlagHash(hash, plan_.seeds[bucket]) & (kSlots - 1);
+    size_t key = plan_.slots[slot];
+    if (key == 0) return -1;
+    key--;
+    // Positional names are in the table only to find duplicates.
+    if (key % 3 == 2) return -1;
+    if (name != internal::GetStaticFlagName(infos_, key)) return -1;
+    return static_cast<int>(key / 3);
+  }
+
+  // Parses |argv| from |from| into |options|. On failure, it sets
+  // |error_message| if it is not null, with the same messages as
+  // FlagParser. "--help" and "-h" fail too, so that the caller can print
+  // help_message().
+  bool Parse(int argc, char** argv, Options* options,
+             std::string* error_message, int from = 1) const {
+    bool is_set[kFlagCount] = {};
+    size_t positional_parsed = 0;
+    for (int i = from; i < argc; ++i) {
+      absl::string_view arg = argv[i];
+      if (arg == "--help" || arg == "-h") {
+        SetErrorMessage(error_message, absl::Substitute("Got \"$0\".", arg));
+        return false;
+      }
+
+      size_t index;
+      if (positional_parsed < plan_.positional_count) {
+        index = plan_.positional_flags[positional_parsed++];
+      } else {
+        // Names can't contain "=", so the name ends at the first one.
+        absl::string_view name = arg.substr(0, arg.find('='));
+        int found = Find(name);
+        if (found < 0) {
+          SetErrorMessage(error_message, absl::Substitute(
+                                             "met unknown argument: \"$0\".",
+                                             arg));
+          return false;
+        }
+        index = static_cast<size_t>(found);
+        arg.remove_prefix(name.length());
+        if (infos_[index].needs_value) {
+          if (!arg.empty()) {
+            arg.remove_prefix(1);
+          } else if (i + 1 < argc) {
+            arg = argv[++i];
+          } else {
+            SetErrorMessage(
+                error_message,
+                absl::Substitute(
+                    "\"$0\" is failed to parse: (reason: empty value ).",
+                    internal::GetStaticFlagDisplayName(infos_[index])));
+            return false;
+          }
+        }
+      }
+
+      std::string reason;
+      if (!ParseValue(index, arg, options, &reason,
+                      std::index_sequence_for<Flags...>())) {
+        SetErrorMessage(
+            error_message,
+            absl::Substitute("\"$0\" is failed to parse: (reason: $1).",
+                             internal::GetStaticFlagDisplayName(infos_[index]),
+                             reason.empty() ? "unknown" : reason));
+        return false;
+      }
+      is_set[index] = true;
+    }
+
+    if (positional_parsed < plan_.positional_count) {
+      SetErrorMessage(
+          error_message,
+          absl::Substitute(
+              "\"$0\" is positional, but not set.",
+              infos_[plan_.positional_flags[positional_parsed]].name));
+      return false;
+    }
+    for (size_t i = 0; i < kFlagCount; ++i) {
+      if (infos_[i].required && !is_set[i]) {
+        SetErrorMessage(
+            error_message,
+            absl::Substitute("\"$0\" is required, but not set.",
+                             internal::GetStaticFlagDisplayName(infos_[i])));
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::string help_message(absl::string_view program_name) const {
+    return internal::GetStaticFlagHelpMessage(program_name, infos_,
+                                              kFlagCount);
+  }
+
+ private:
+  typedef bool (*ParseValueFunction)(const StaticFlagSchema& schema,
+                                     absl::string_view arg, Options* options,
+                                     std::string* reason);
+
+  template <size_t I>
+  static bool ParseValueAt(const StaticFlagSchema& schema,
+                           absl::string_view arg, Options* options,
+                           std::string* reason) {
+    return internal::GetStaticFlag<I>(schema.flags_).ParseValue(arg, options,
+                                                                 reason);
+  }
+
+  // Dispatches to the flag at |index| through a table of functions, one per
+  // type of flag.
+  template <size_t... I>
+  bool ParseValue(size_t index, absl::string_view arg, Options* options,
+                  std::string* reason, std::index_sequence<I...>) const {
+    static constexpr ParseValueFunction kParseValueFunctions[] = {
+        &ParseValueAt<I>...};
+    return kParseValueFunctions[index](*this, arg, options, reason);
+  }
+
+  static void SetErrorMessage(std::string* error_message,
+                              std::string message) {
+    if (error_message) *error_message = std::move(message);
+  }
+
+  internal::StaticFlagStorage<std::index_sequence_for<Flags...>, Flags...>
+      flags_;
+  StaticFlagInfo infos_[kFlagCount];
+  internal::StaticFlagPlan<kFlagCount, kSlots, kBuckets> plan_;
+};
+
+template <typename... Flags>
+constexpr StaticFlagSchema<
+    typename internal::FirstStaticFlag<Flags...>::type::options_type, Flags...>
+MakeStaticFlagSchema(const Flags&... flags) {
+  return StaticFlagSchema<
+      typename internal::FirstStaticFlag<Flags...>::type::options_type,
+      Flags...>(flags...);
+}
+
+}  // namespace console
+
+#endif  // CONSOLE_STATIC_FLAG_SCHEMA_H_
@@ -0,0 +1,138 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/static_flag_schema.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace console {
+
+namespace {
+
+struct Options {
+  absl::string_view input;
+  int32_t jobs = 1;
+  bool verbose = false;
+  std::string output;
+};
+
+constexpr auto kSchema = MakeStaticFlagSchema(
+    MakeStaticPositionalFlag(&Options::input, "input", "The input"),
+    MakeStaticFlag(&Options::jobs, "-j", "--jobs", "The number of jobs"),
+    MakeStaticFlag(&Options::verbose, "-v", "--verbose", "Logs more"),
+    MakeStaticFlag(&Options::output, "", "--output", "The output", true));
+
+// The names are checked at compile time.
+static_assert(internal::CheckStaticFlagNames(&kSchema.info(0), 4), "");
+
+// 200 flags, "-f100" and "--flag100" to "-f299" and "--flag299".
+#define FLAG(n) MakeStaticFlag(&Options::jobs, "-f" #n, "--flag" #n, "")
+#define FLAGS10(n)                                                         \
+  FLAG(n##0), FLAG(n##1), FLAG(n##2), FLAG(n##3), FLAG(n##4), FLAG(n##5), \
+      FLAG(n##6), FLAG(n##7), FLAG(n##8), FLAG(n##9)
+#define FLAGS100(n)                                                      \
+  FLAGS10(n##0), FLAGS10(n##1), FLAGS10(n##2), FLAGS10(n##3),            \
+      FLAGS10(n##4), FLAGS10(n##5), FLAGS10(n##6), FLAGS10(n##7),        \
+      FLAGS10(n##8), FLAGS10(n##9)
+
+constexpr auto kLargeSchema = MakeStaticFlagSchema(FLAGS100(1), FLAGS100(2));
+
+#undef FLAGS100
+#undef FLAGS10
+#undef FLAG
+
+bool Parse(std::vector<const char*> args, Options* options,
+           std::string* error_message) {
+  args.insert(args.begin(), "program");
+  return kSchema.Parse(static_cast<int>(args.size()),
+                       const_cast<char**>(args.data()), options,
+                       error_message);
+}
+
+}  // namespace
+
+TEST(StaticFlagSchemaTest, Find) {
+  EXPECT_EQ(kSchema.Find("-j"), 1);
+  EXPECT_EQ(kSchema.Find("--jobs"), 1);
+  EXPECT_EQ(kSchema.Find("-v"), 2);
+  EXPECT_EQ(kSchema.Find("--verbose"), 2);
+  EXPECT_EQ(kSchema.Find("--output"), 3);
+  EXPECT_EQ(kSchema.Find("input"), -1);
+  EXPECT_EQ(kSchema.Find(""), -1);
+  EXPECT_EQ(kSchema.Find("--job"), -1);
+}
+
+TEST(StaticFlagSchemaTest, FindLarge) {
+  ASSERT_EQ(kLargeSchema.size(), 200u);
+  for (int i = 0; i < 200; ++i) {
+    std::string number = std::to_string(100 + i);
+    EXPECT_EQ(kLargeSchema.Find("-f" + number), i);
+    EXPECT_EQ(kLargeSchema.Find("--flag" + number), i);
+  }
+  EXPECT_EQ(kLargeSchema.Find("--flag300"), -1);
+  EXPECT_EQ(kLargeSchema.Find("--flag"), -1);
+}
+
+TEST(StaticFlagSchemaTest, Parse) {
+  Options options;
+  std::string error_message;
+  ASSERT_TRUE(Parse({"in.txt", "-j", "4", "--verbose", "--output=out.txt"},
+                    &options, &error_message));
+  EXPECT_EQ(options.input, "in.txt");
+  EXPECT_EQ(options.jobs, 4);
+  EXPECT_TRUE(options.verbose);
+  EXPECT_EQ(options.output, "out.txt");
+
+  ASSERT_TRUE(Parse({"in.txt", "--jobs=8", "--output", "a"}, &options,
+                    &error_message));
+  EXPECT_EQ(options.jobs, 8);
+  EXPECT_EQ(options.output, "a");
+}
+
+TEST(StaticFlagSchemaTest, Errors) {
+  Options options;
+  std::string error_message;
+  EXPECT_FALSE(Parse({}, &options, &error_message));
+  EXPECT_EQ(error_message, "\"input\" is positional, but not set.");
+
+  EXPECT_FALSE(Parse({"in.txt"}, &options, &error_message));
+  EXPECT_EQ(error_message, "\"--output\" is required, but not set.");
+
+  EXPECT_FALSE(Parse({"in.txt", "--jobz=1"}, &options, &error_message));
+  EXPECT_EQ(error_message, "met unknown argument: \"--jobz=1\".");
+
+  EXPECT_FALSE(Parse({"in.txt", "--jobs=a"}, &options, &error_message));
+  EXPECT_EQ(error_message,
+            "\"--jobs\" is failed to parse: (reason: failed to convert "
+            "int (\"a\")).");
+
+  EXPECT_FALSE(Parse({"in.txt", "--jobs"}, &options, &error_message));
+  EXPECT_EQ(error_message,
+            "\"--jobs\" is failed to parse: (reason: empty value ).");
+
+  EXPECT_FALSE(Parse({"--help"}, &options, &error_message));
+  EXPECT_EQ(error_message, "Got \"--help\".");
+}
+
+TEST(StaticFlagSchemaTest, HelpMessage) {
+  EXPECT_EQ(kSchema.help_message("program"),
+            "Usage: \n"
+            "\n"
+            "program input [-j] [-v] [--output]\n"
+            "\n"
+            "Positional arguments:\n"
+            "\n"
+            "input               The input\n"
+            "\n"
+            "Optional arguments:\n"
+            "\n"
+            "-j, --jobs          The number of jobs\n"
+            "-v, --verbose       Logs more\n"
+            "--output            The output\n");
+}
+
+}  // namespace console
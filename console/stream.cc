@@ -4,19 +4,51 @@
 
 #include "console/stream.h"
 
+#include <string.h>
+
 #include "color/color_conversion.h"
+#include "console/adaptive_quality.h"
+#include "console/metrics.h"
+#include "console/tracing.h"
 
 namespace console {
 
-Stream::Stream(std::ostream& ostream)
-    : ostream_(ostream), console_info_(Console::GetInfo()) {}
+namespace {
+
+#if defined(CONSOLE_ENABLE_METRICS)
+size_t CountDigits(size_t n) {
+  size_t digits = 1;
+  while (n >= 10) {
+    n /= 10;
+    digits++;
+  }
+  return digits;
+}
+#endif
+
+}  // namespace
+
+Stream::Stream(std::ostream& ostream) : ostream_(ostream) {
+  RefreshConsoleInfo();
+}
 
 Stream::~Stream() { Reset(); }
 
-#define SGR_PARAMETERS_LIST(name, code) \
-  Stream& Stream::name() {              \
-    ostream_ << k##name;                \
-    return *this;                       \
+void Stream::RefreshConsoleInfo() {
+  console_info_ = Console::GetInfo();
+  AdaptiveQualityController* controller =
+      AdaptiveQualityController::GetCurrent();
+  if (controller) controller->Apply(&console_info_);
+}
+
+const Console::Info& Stream::console_info() const { return console_info_; }
+
+#define SGR_PARAMETERS_LIST(name, code)                            \
+  Stream& Stream::name() {                                         \
+    ostream_ << k##name;                                           \
+    CONSOLE_METRICS(                                               \
+        Metrics::RecordEscape(EscapeKind::kSgr, strlen(k##name))); \
+    return *this;                                                  \
   }
 #include "console/sgr_parameters_list.h"
 #undef SGR_PARAMETERS_LIST
@@ -26,16 +58,45 @@ Stream& Stream::Rgb(color::Rgb rgb) {
 }
 
 Stream& Stream::Rgb(uint8_t r, uint8_t g, uint8_t b) {
+  EscapeKind kind;
+  std::string escape = GetRgbEscape(color::Rgb(r, g, b), &kind);
+  if (!escape.empty()) WriteColor(kind, escape);
+  return *this;
+}
+
+Stream& Stream::Rgb(color::Rgb rgb, size_t x, size_t y) {
+  EscapeKind kind;
+  std::string escape = GetRgbEscape(rgb, x, y, &kind);
+  if (!escape.empty()) WriteColor(kind, escape);
+  return *this;
+}
+
+std::string Stream::GetRgbEscape(color::Rgb rgb, EscapeKind* kind) const {
+  uint8_t r = rgb.data.r;
+  uint8_t g = rgb.data.g;
+  uint8_t b = rgb.data.b;
   if (console_info_.support_truecolor) {
-    ostream_ << Rgb24(r, g, b);
-  } else if (console_info_.support_8bit_color) {
-    if (r == g && g == b) {
-      ostream_ << Grayscale8(r * (23.0 / 255.0));
-    } else {
-      ostream_ << Rgb8(r, g, b);
-    }
+    *kind = EscapeKind::kColor24;
+    return Rgb24(r, g, b);
   }
-  return *this;
+  if (console_info_.support_8bit_color) {
+    *kind = EscapeKind::kColor8;
+    if (r == g && g == b) return Grayscale8(r * (23.0 / 255.0));
+    return Rgb8(r, g, b);
+  }
+  *kind = EscapeKind::kColor4;
+  if (console_info_.support_4bit_color) return Rgb4(r, g, b);
+  return std::string();
+}
+
+std::string Stream::GetRgbEscape(color::Rgb rgb, size_t x, size_t y,
+                                 EscapeKind* kind) const {
+  if (console_info_.support_truecolor || console_info_.support_8bit_color ||
+      !console_info_.support_4bit_color) {
+    return GetRgbEscape(rgb, kind);
+  }
+  *kind = EscapeKind::kColor4;
+  return Rgb4(rgb.data.r, rgb.data.g, rgb.data.b, x, y);
 }
 
 Stream& Stream::BgRgb(color::Rgb rgb) {
@@ -44,125 +105,207 @@ Stream& Stream::BgRgb(color::Rgb rgb) {
 
 Stream& Stream::BgRgb(uint8_t r, uint8_t g, uint8_t b) {
   if (console_info_.support_truecolor) {
-    ostream_ << BgRgb24(r, g, b);
+    WriteColor(EscapeKind::kColor24, BgRgb24(r, g, b));
   } else if (console_info_.support_8bit_color) {
     if (r == g && g == b) {
-      ostream_ << BgGrayscale8(r * (23.0 / 255.0));
+      WriteColor(EscapeKind::kColor8, BgGrayscale8(r * (23.0 / 255.0)));
     } else {
-      ostream_ << BgRgb8(r, g, b);
+      WriteColor(EscapeKind::kColor8, BgRgb8(r, g, b));
     }
+  } else if (console_info_.support_4bit_color) {
+    WriteColor(EscapeKind::kColor4, BgRgb4(r, g, b));
+  }
+  return *this;
+}
+
+Stream& Stream::BgRgb(color::Rgb rgb, size_t x, size_t y) {
+  if (console_info_.support_truecolor || console_info_.support_8bit_color ||
+      !console_info_.support_4bit_color) {
+    return BgRgb(rgb);
+  }
+  WriteColor(EscapeKind::kColor4,
+             BgRgb4(rgb.data.r, rgb.data.g, rgb.data.b, x, y));
+  return *this;
+}
+
+Stream& Stream::Write(absl::string_view text) {
+  ostream_ << text;
+  CONSOLE_METRICS(Metrics::RecordBytesWritten(text.length()));
+  return *this;
+}
+
+Stream& Stream::Write(char c) {
+  ostream_ << c;
+  CONSOLE_METRICS(Metrics::RecordBytesWritten(1));
+  return *this;
+}
+
+Stream& Stream::Flush() {
+  CONSOLE_TRACE_EVENT("Stream::Flush");
+  AdaptiveQualityController* controller =
+      AdaptiveQualityController::GetCurrent();
+  if (!Metrics::kEnabled && !controller) {
+    ostream_.flush();
+    return *this;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  ostream_.flush();
+  auto blocked = std::chrono::steady_clock::now() - start;
+  CONSOLE_METRICS(Metrics::RecordFlush(blocked));
+  if (controller) {
+    controller->RecordWrite(blocked);
+    controller->Evaluate();
   }
   return *this;
 }
 
 Stream& Stream::SetCursor(size_t row, size_t column) {
   ostream_ << "\e[" << row << ";" << column << "H";
+  CONSOLE_METRICS(Metrics::RecordEscape(
+      EscapeKind::kCursor, 4 + CountDigits(row) + CountDigits(column)));
   return *this;
 }
 
 Stream& Stream::CursorUp(size_t n) {
   ostream_ << "\e[" << n << "A";
+  CONSOLE_METRICS(Metrics::RecordEscape(
+      EscapeKind::kCursor, 3 + CountDigits(n)));
   return *this;
 }
 
 Stream& Stream::CursorDown(size_t n) {
   ostream_ << "\e[" << n << "B";
+  CONSOLE_METRICS(Metrics::RecordEscape(
+      EscapeKind::kCursor, 3 + CountDigits(n)));
   return *this;
 }
 
 Stream& Stream::CursorForward(size_t n) {
   ostream_ << "\e[" << n << "C";
+  CONSOLE_METRICS(Metrics::RecordEscape(
+      EscapeKind::kCursor, 3 + CountDigits(n)));
   return *this;
 }
 
 Stream& Stream::CursorBackward(size_t n) {
   ostream_ << "\e[" << n << "D";
+  CONSOLE_METRICS(Metrics::RecordEscape(
+      EscapeKind::kCursor, 3 + CountDigits(n)));
   return *this;
 }
 
 Stream& Stream::SaveCursor() {
   ostream_ << "\e[s";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kCursor, 3));
   return *this;
 }
 
 Stream& Stream::RestoreCursor() {
   ostream_ << "\e[u";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kCursor, 3));
   return *this;
 }
 
 Stream& Stream::SaveCursorAndAttributes() {
   ostream_ << "\e7";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kCursor, 2));
   return *this;
 }
 
 Stream& Stream::RestoreCursorAndAttributes() {
   ostream_ << "\e8";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kCursor, 2));
   return *this;
 }
 
 Stream& Stream::ScrollScreen() {
   ostream_ << "\e[r";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kScroll, 3));
   return *this;
 }
 
 Stream& Stream::ScrollScreen(size_t start, size_t end) {
   ostream_ << "\e[" << start << ";" << end << "r";
+  CONSOLE_METRICS(Metrics::RecordEscape(
+      EscapeKind::kScroll, 4 + CountDigits(start) + CountDigits(end)));
   return *this;
 }
 
 Stream& Stream::ScrollDown() {
   ostream_ << "\eD";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kScroll, 2));
   return *this;
 }
 
 Stream& Stream::ScrollUp() {
   ostream_ << "\eM";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kScroll, 2));
   return *this;
 }
 
 Stream& Stream::SetTab() {
   ostream_ << "\eH";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kTab, 2));
   return *this;
 }
 
 Stream& Stream::ClearTab() {
   ostream_ << "\e[g";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kTab, 3));
   return *this;
 }
 
 Stream& Stream::ClearAllTab() {
   ostream_ << "\e[3g";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kTab, 4));
   return *this;
 }
 
 Stream& Stream::EraseEndOfLine() {
   ostream_ << "\e[K";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kErase, 3));
   return *this;
 }
 
 Stream& Stream::EraseStartOfLine() {
   ostream_ << "\e[1K";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kErase, 4));
   return *this;
 }
 
 Stream& Stream::EraseEntireLine() {
   ostream_ << "\e[2K";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kErase, 4));
   return *this;
 }
 
 Stream& Stream::EraseDown() {
   ostream_ << "\e[J";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kErase, 3));
   return *this;
 }
 
 Stream& Stream::EraseUp() {
   ostream_ << "\e[1J";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kErase, 4));
   return *this;
 }
 
 Stream& Stream::EraseScreen() {
   ostream_ << "\e[2J";
+  CONSOLE_METRICS(Metrics::RecordEscape(EscapeKind::kErase, 4));
   return *this;
 }
 
+void Stream::WriteColor(EscapeKind kind, const char* escape) {
+  ostream_ << escape;
+  CONSOLE_METRICS(Metrics::RecordEscape(kind, strlen(escape)));
+}
+
+void Stream::WriteColor(EscapeKind kind, const std::string& escape) {
+  ostream_ << escape;
+  CONSOLE_METRICS(Metrics::RecordEscape(kind, escape.length()));
+}
+
 }  // namespace console
\ No newline at end of file
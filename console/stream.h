@@ -8,10 +8,13 @@
 #include <stdint.h>
 
 #include <iostream>
+#include <string>
 
+#include "absl/strings/string_view.h"
 #include "color/color.h"
 #include "console/console.h"
 #include "console/export.h"
+#include "console/metrics.h"
 #include "console/sgr_parameters.h"
 
 namespace console {
@@ -21,14 +24,40 @@ class CONSOLE_EXPORT Stream {
   explicit Stream(std::ostream& ostream_ = std::cout);
   ~Stream();
 
+  // Re-reads Console::GetInfo() and applies the current
+  // AdaptiveQualityController to it. A Stream reads them once on
+  // construction, so a long lived one calls this every frame.
+  void RefreshConsoleInfo();
+  const Console::Info& console_info() const;
+
 #define SGR_PARAMETERS_LIST(name, code) Stream& name();
 #include "console/sgr_parameters_list.h"
 #undef SGR_PARAMETERS_LIST
 
+  // If the terminal supports neither truecolor nor 8 bit color, the closest
+  // one among the 16 ANSI colors is used.
   Stream& Rgb(color::Rgb rgb);
   Stream& Rgb(uint8_t r, uint8_t g, uint8_t b);
   Stream& BgRgb(color::Rgb rgb);
   Stream& BgRgb(uint8_t r, uint8_t g, uint8_t b);
+  // Same as above, but the 16 colors are ordered dithered by the cell
+  // position (|x|, |y|). It's useful for gradients.
+  Stream& Rgb(color::Rgb rgb, size_t x, size_t y);
+  Stream& BgRgb(color::Rgb rgb, size_t x, size_t y);
+  // Returns the escape sequence Rgb() writes for |rgb|, or an empty string if
+  // the terminal has no colors, and sets |kind| to its kind. It's for callers
+  // drawing many cells with few colors, which format each color once.
+  std::string GetRgbEscape(color::Rgb rgb, EscapeKind* kind) const;
+  std::string GetRgbEscape(color::Rgb rgb, size_t x, size_t y,
+                           EscapeKind* kind) const;
+
+  // Writes plain |text|. Unlike writing to the underlying std::ostream
+  // directly, this is counted by Metrics.
+  Stream& Write(absl::string_view text);
+  Stream& Write(char c);
+  // Flushes the underlying std::ostream. The time blocked in here is counted
+  // by Metrics and reported to the current AdaptiveQualityController.
+  Stream& Flush();
 
   // Cursor Conrol
   // Sets the cursor position where subsequent text will begin. If no row/column
@@ -85,6 +114,9 @@ class CONSOLE_EXPORT Stream {
   Stream& EraseScreen();
 
  private:
+  void WriteColor(EscapeKind kind, const char* escape);
+  void WriteColor(EscapeKind kind, const std::string& escape);
+
   std::ostream& ostream_;
   Console::Info console_info_;
 };
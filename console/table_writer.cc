@@ -0,0 +1,220 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/table_writer.h"
+
+#include <algorithm>
+
+#include "console/memory_mapped_file.h"
+
+namespace console {
+
+namespace {
+
+constexpr char kSpaces[] = "                                ";
+constexpr size_t kSpacesLength = sizeof(kSpaces) - 1;
+
+constexpr char kEllipsis[] = "…";
+
+bool IsContinuationByte(char c) { return (c & 0xc0) == 0x80; }
+
+// Returns the number of code points in |text|.
+size_t GetWidth(absl::string_view text) {
+  size_t width = 0;
+  for (char c : text) width += !IsContinuationByte(c);
+  return width;
+}
+
+// Returns the first |width| code points of |text|.
+absl::string_view Truncate(absl::string_view text, size_t width) {
+  size_t i = 0;
+  for (; i < text.length(); ++i) {
+    if (!IsContinuationByte(text[i]) && width-- == 0) break;
+  }
+  return text.substr(0, i);
+}
+
+// Calls |callback| with the cells of every line of |data|, split at
+// |delimiter|. |cells| is reused for every line.
+template <typename Callback>
+void ForEachRow(absl::string_view data, char delimiter,
+                std::vector<absl::string_view>* cells, Callback callback) {
+  while (!data.empty()) {
+    size_t end = data.find('\n');
+    absl::string_view line = data.substr(0, end);
+    data.remove_prefix(end == absl::string_view::npos ? data.length()
+                                                      : end + 1);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+    cells->clear();
+    while (true) {
+      size_t i = line.find(delimiter);
+      cells->push_back(line.substr(0, i));
+      if (i == absl::string_view::npos) break;
+      line.remove_prefix(i + 1);
+    }
+    callback(cells->data(), cells->size());
+  }
+}
+
+}  // namespace
+
+constexpr size_t TableWriter::kDefaultSampleRows;
+
+TableWriter::TableWriter(Stream* stream, std::vector<Column> columns)
+    : stream_(stream), columns_(std::move(columns)) {
+  widths_.reserve(columns_.size());
+  for (const Column& column : columns_) {
+    size_t width = GetWidth(column.header);
+    if (column.max_width > 0) width = std::min(width, column.max_width);
+    widths_.push_back(width);
+  }
+  cells_.reserve(columns_.size());
+}
+
+TableWriter::~TableWriter() = default;
+
+void TableWriter::set_separator(absl::string_view separator) {
+  separator_ = std::string(separator);
+}
+
+void TableWriter::set_sample_rows(size_t sample_rows) {
+  sample_rows_ = sample_rows;
+}
+
+size_t TableWriter::sample_rows() const { return sample_rows_; }
+
+void TableWriter::AddRow(std::initializer_list<absl::string_view> cells) {
+  AddRow(cells.begin(), cells.size());
+}
+
+void TableWriter::AddRow(const absl::string_view* cells, size_t n) {
+  if (header_written_) {
+    WriteRow(cells, n);
+    return;
+  }
+
+  Measure(cells, n);
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    if (i < n) sample_text_.append(cells[i].data(), cells[i].length());
+    sample_ends_.push_back(sample_text_.length());
+  }
+  if (sample_ends_.size() >= sample_rows_ * columns_.size()) FlushSample();
+}
+
+void TableWriter::Finish() {
+  if (!header_written_) FlushSample();
+}
+
+void TableWriter::WriteDelimited(absl::string_view data, char delimiter) {
+  ForEachRow(data, delimiter, &cells_,
+             [this](const absl::string_view* cells, size_t n) {
+               Measure(cells, n);
+             });
+  WriteHeader();
+  ForEachRow(data, delimiter, &cells_,
+             [this](const absl::string_view* cells, size_t n) {
+               WriteRow(cells, n);
+             });
+}
+
+bool TableWriter::WriteFile(const std::string& path, char delimiter) {
+  MemoryMappedFile file;
+  if (!file.Initialize(path)) return false;
+  WriteDelimited(file.data(), delimiter);
+  return true;
+}
+
+size_t TableWriter::width(size_t index) const { return widths_[index]; }
+
+size_t TableWriter::rows_written() const { return rows_written_; }
+
+void TableWriter::Measure(const absl::string_view* cells, size_t n) {
+  n = std::min(n, columns_.size());
+  for (size_t i = 0; i < n; ++i) {
+    size_t width = GetWidth(cells[i]);
+    if (columns_[i].max_width > 0) {
+      width = std::min(width, columns_[i].max_width);
+    }
+    widths_[i] = std::max(widths_[i], width);
+  }
+}
+
+void TableWriter::WriteHeader() {
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    if (i > 0) stream_->Write(separator_);
+    WriteCell(i, columns_[i].header, true);
+  }
+  stream_->Write('\n');
+  header_written_ = true;
+}
+
+void TableWriter::WriteRow(const absl::string_view* cells, size_t n) {
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    if (i > 0) stream_->Write(separator_);
+    WriteCell(i, i < n ? cells[i] : absl::string_view(), false);
+  }
+  stream_->Write('\n');
+  rows_written_++;
+}
+
+void TableWriter::WriteCell(size_t index, absl::string_view cell,
+                            bool header) {
+  const Column& column = columns_[index];
+  size_t width = widths_[index];
+  size_t cell_width = GetWidth(cell);
+  absl::string_view text = cell;
+  bool truncated = cell_width > width;
+  if (truncated) {
+    // The ellipsis takes the last cell, if there is room for it.
+    text = Truncate(cell, width > 0 ? width - 1 : 0);
+    truncated = width > 0;
+    cell_width = width;
+  }
+
+  size_t padding = width - cell_width;
+  if (column.alignment == Alignment::kRight) WritePadding(padding);
+  bool styled = header || column.style;
+  if (header) {
+    stream_->Bold();
+  } else if (column.style) {
+    column.style(*stream_, rows_written_, cell);
+  }
+  stream_->Write(text);
+  if (truncated) stream_->Write(kEllipsis);
+  if (styled) stream_->Reset();
+  // Trailing spaces of the last column would only wrap narrow terminals.
+  if (column.alignment == Alignment::kLeft && index + 1 < columns_.size()) {
+    WritePadding(padding);
+  }
+}
+
+void TableWriter::WritePadding(size_t n) {
+  while (n > 0) {
+    size_t length = std::min(n, kSpacesLength);
+    stream_->Write(absl::string_view(kSpaces, length));
+    n -= length;
+  }
+}
+
+void TableWriter::FlushSample() {
+  WriteHeader();
+  size_t n = columns_.size();
+  size_t begin = 0;
+  for (size_t row = 0; row * n < sample_ends_.size(); ++row) {
+    cells_.clear();
+    for (size_t i = 0; i < n; ++i) {
+      size_t end = sample_ends_[row * n + i];
+      cells_.push_back(
+          absl::string_view(sample_text_.data() + begin, end - begin));
+      begin = end;
+    }
+    WriteRow(cells_.data(), n);
+  }
+  // The buffers aren't needed anymore.
+  std::string().swap(sample_text_);
+  std::vector<size_t>().swap(sample_ends_);
+}
+
+}  // namespace console
@@ -0,0 +1,129 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_TABLE_WRITER_H_
+#define CONSOLE_TABLE_WRITER_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "console/export.h"
+#include "console/stream.h"
+
+namespace console {
+
+// TableWriter writes rows as a table with aligned columns, however many rows
+// there are. Its memory usage doesn't grow with the number of rows, so it can
+// print results of hundreds of thousands of rows as they are produced.
+//
+// The width of the columns is decided in one of two ways:
+//
+// - Sampled: AddRow() buffers the first sample_rows() rows and sizes the
+//   columns to fit them. From then on, every row is written as soon as it is
+//   added, and cells wider than their column are truncated with an ellipsis.
+// - Exact: WriteFile() and WriteDelimited() read delimited rows twice, once
+//   to size the columns and once to write them. A file is memory mapped, so
+//   it is never loaded into memory as a whole.
+//
+// Widths are counted in code points of UTF-8 text and capped by
+// Column::max_width. Cells are styled through Stream by Column::style.
+//
+// std::vector<TableWriter::Column> columns(2);
+// columns[0].header = "Name";
+// columns[1].header = "Size";
+// columns[1].alignment = TableWriter::Alignment::kRight;
+// TableWriter table(&stream, std::move(columns));
+// for (...) table.AddRow({name, size});
+// table.Finish();
+class CONSOLE_EXPORT TableWriter {
+ public:
+  enum class Alignment {
+    kLeft,
+    kRight,
+  };
+
+  // Called before writing |cell| of the |row|th row to set its attributes,
+  // which are reset after the cell.
+  typedef std::function<void(Stream& stream, size_t row,
+                             absl::string_view cell)>
+      CellStyle;
+
+  struct Column {
+    std::string header;
+    Alignment alignment = Alignment::kLeft;
+    // The widest the column gets, in cells. 0 means no limit.
+    size_t max_width = 0;
+    CellStyle style;
+  };
+
+  static constexpr size_t kDefaultSampleRows = 100;
+
+  TableWriter(Stream* stream, std::vector<Column> columns);
+  TableWriter(const TableWriter& other) = delete;
+  TableWriter& operator=(const TableWriter& other) = delete;
+  ~TableWriter();
+
+  // Sets what is written between columns. It is two spaces by default.
+  void set_separator(absl::string_view separator);
+  // Sets how many rows AddRow() buffers to size the columns. It must be set
+  // before the first row is added.
+  void set_sample_rows(size_t sample_rows);
+  size_t sample_rows() const;
+
+  // Adds a row. Missing cells are empty and extra cells are ignored.
+  void AddRow(std::initializer_list<absl::string_view> cells);
+  void AddRow(const absl::string_view* cells, size_t n);
+  // Writes the rows which are still buffered, if fewer than sample_rows()
+  // rows were added.
+  void Finish();
+
+  // Writes every line of |data| as a row whose cells are separated by
+  // |delimiter|, sizing the columns to fit all of them. A trailing '\r' is
+  // removed from each line.
+  void WriteDelimited(absl::string_view data, char delimiter = '\t');
+  // Same as above, but reads the rows from the file at |path|. Returns false
+  // if the file can't be mapped.
+  bool WriteFile(const std::string& path, char delimiter = '\t');
+
+  // Returns the width of the |index|th column. It is final once the header is
+  // written.
+  size_t width(size_t index) const;
+  size_t rows_written() const;
+
+ private:
+  // Widens the columns to fit |cells|.
+  void Measure(const absl::string_view* cells, size_t n);
+  void WriteHeader();
+  void WriteRow(const absl::string_view* cells, size_t n);
+  // Writes |cell| of the |index|th column, in bold if |header| is true.
+  void WriteCell(size_t index, absl::string_view cell, bool header);
+  void WritePadding(size_t n);
+  // Writes the header and the buffered rows.
+  void FlushSample();
+
+  Stream* const stream_;
+  std::vector<Column> columns_;
+  std::vector<size_t> widths_;
+  std::string separator_ = "  ";
+  size_t sample_rows_ = kDefaultSampleRows;
+
+  // The buffered rows, back to back. |sample_ends_| has the end offset of
+  // every cell, columns_.size() cells per row.
+  std::string sample_text_;
+  std::vector<size_t> sample_ends_;
+  // Reused to hand cells to WriteRow().
+  std::vector<absl::string_view> cells_;
+
+  bool header_written_ = false;
+  size_t rows_written_ = 0;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_TABLE_WRITER_H_
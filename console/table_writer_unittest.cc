@@ -0,0 +1,130 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/table_writer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace console {
+
+namespace {
+
+std::vector<TableWriter::Column> CreateColumns() {
+  std::vector<TableWriter::Column> columns(2);
+  columns[0].header = "Name";
+  columns[1].header = "Size";
+  columns[1].alignment = TableWriter::Alignment::kRight;
+  return columns;
+}
+
+// Drops the escape sequences of the header.
+std::string StripBold(std::string text) {
+  for (const char* escape : {kBold, kReset}) {
+    size_t i;
+    while ((i = text.find(escape)) != std::string::npos) {
+      text.erase(i, strlen(escape));
+    }
+  }
+  return text;
+}
+
+}  // namespace
+
+TEST(TableWriterTest, Sampled) {
+  std::stringstream ss;
+  Stream stream(ss);
+  TableWriter table(&stream, CreateColumns());
+  table.set_sample_rows(2);
+  table.AddRow({"apple", "3"});
+  table.AddRow({"fig", "120"});
+  // The columns are sized once the sample is full.
+  EXPECT_EQ(table.width(0), 5u);
+  EXPECT_EQ(table.width(1), 4u);
+  EXPECT_EQ(table.rows_written(), 2u);
+
+  table.AddRow({"watermelon", "12345"});
+  table.AddRow({"kiwi"});
+  table.Finish();
+  EXPECT_EQ(table.rows_written(), 4u);
+  EXPECT_EQ(StripBold(ss.str()),
+            "Name   Size\n"
+            "apple     3\n"
+            "fig     120\n"
+            "wate…  123…\n"
+            "kiwi       \n");
+}
+
+TEST(TableWriterTest, Finish) {
+  std::stringstream ss;
+  Stream stream(ss);
+  std::vector<TableWriter::Column> columns = CreateColumns();
+  columns[0].max_width = 3;
+  TableWriter table(&stream, std::move(columns));
+  table.set_separator(" | ");
+  table.AddRow({"ひらがな", "1"});
+  EXPECT_EQ(table.rows_written(), 0u);
+  table.Finish();
+  EXPECT_EQ(StripBold(ss.str()),
+            "Na… | Size\n"
+            "ひら… |    1\n");
+}
+
+TEST(TableWriterTest, Style) {
+  std::stringstream ss;
+  Stream stream(ss);
+  std::vector<TableWriter::Column> columns(1);
+  columns[0].style = [](Stream& stream, size_t row, absl::string_view cell) {
+    if (row == 1) stream.Underline();
+  };
+  TableWriter table(&stream, std::move(columns));
+  table.AddRow({"a"});
+  table.AddRow({"b"});
+  table.Finish();
+  EXPECT_EQ(ss.str(), std::string(kBold) + kReset + "\n" + "a" + kReset +
+                          "\n" + kUnderline + "b" + kReset + "\n");
+}
+
+TEST(TableWriterTest, Delimited) {
+  std::stringstream ss;
+  Stream stream(ss);
+  TableWriter table(&stream, CreateColumns());
+  table.WriteDelimited("a\t1\r\nwatermelon\t12345\n\nb,2\t3\n");
+  EXPECT_EQ(table.rows_written(), 4u);
+  EXPECT_EQ(StripBold(ss.str()),
+            "Name         Size\n"
+            "a               1\n"
+            "watermelon  12345\n"
+            "                 \n"
+            "b,2             3\n");
+}
+
+TEST(TableWriterTest, WriteFile) {
+  std::string path = ::testing::TempDir() + "table_writer_unittest.tsv";
+  {
+    std::ofstream file(path);
+    for (int i = 0; i < 1000; ++i) file << "row" << i << '\t' << i << '\n';
+  }
+
+  std::stringstream ss;
+  Stream stream(ss);
+  TableWriter table(&stream, CreateColumns());
+  EXPECT_TRUE(table.WriteFile(path, '\t'));
+  EXPECT_EQ(table.rows_written(), 1000u);
+  // Sized by the last row, unlike the sampled mode.
+  EXPECT_EQ(table.width(0), 6u);
+  EXPECT_NE(ss.str().find("row999   999\n"), std::string::npos);
+  remove(path.c_str());
+
+  EXPECT_FALSE(table.WriteFile(path, '\t'));
+}
+
+}  // namespace console
@@ -0,0 +1,132 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/thread_pool.h"
+
+#include "console/tracing.h"
+
+namespace console {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  for (size_t i = 0; i <= num_threads; ++i) {
+    queues_.emplace_back(new Queue());
+  }
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&ThreadPool::RunWorker, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& thread : threads_) thread.join();
+}
+
+// static
+ThreadPool* ThreadPool::GetDefault() {
+  static ThreadPool* thread_pool = []() {
+    size_t num_threads = std::thread::hardware_concurrency();
+    return new ThreadPool(num_threads > 0 ? num_threads - 1 : 0);
+  }();
+  return thread_pool;
+}
+
+size_t ThreadPool::num_threads() const { return threads_.size(); }
+
+void ThreadPool::ParallelFor(size_t n,
+                             const std::function<void(size_t)>& task) {
+  if (n == 0) return;
+  if (threads_.empty() || n == 1) {
+    for (size_t i = 0; i < n; ++i) task(i);
+    return;
+  }
+
+  std::lock_guard<std::mutex> parallel_for_lock(parallel_for_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    remaining_ = n;
+  }
+
+  // Hands out contiguous ranges so that neighbouring tasks, which usually
+  // cost about the same, start on the same thread.
+  size_t num_queues = queues_.size();
+  for (size_t i = 0; i < num_queues; ++i) {
+    size_t begin = n * i / num_queues;
+    size_t end = n * (i + 1) / num_queues;
+    std::lock_guard<std::mutex> lock(queues_[i]->mutex);
+    for (size_t j = begin; j < end; ++j) queues_[i]->indices.push_back(j);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+  }
+  work_cv_.notify_all();
+
+  RunTasks(num_queues - 1);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() { return remaining_ == 0; });
+  task_ = nullptr;
+}
+
+bool ThreadPool::PopOrSteal(size_t queue_index, size_t* index) {
+  {
+    Queue* queue = queues_[queue_index].get();
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->indices.empty()) {
+      *index = queue->indices.back();
+      queue->indices.pop_back();
+      return true;
+    }
+  }
+
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    Queue* queue = queues_[(queue_index + i) % queues_.size()].get();
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->indices.empty()) {
+      *index = queue->indices.front();
+      queue->indices.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::RunTasks(size_t queue_index) {
+  size_t index;
+  while (PopOrSteal(queue_index, &index)) {
+    const std::function<void(size_t)>* task;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      task = task_;
+    }
+    (*task)(index);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--remaining_ == 0) done_cv_.notify_all();
+  }
+}
+
+void ThreadPool::RunWorker(size_t queue_index) {
+  uint64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock, [this, generation]() {
+        return stopped_ || generation_ != generation;
+      });
+      if (stopped_) return;
+      generation = generation_;
+    }
+    CONSOLE_TRACE_EVENT("ThreadPool::RunTasks");
+    RunTasks(queue_index);
+  }
+}
+
+}  // namespace console
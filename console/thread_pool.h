@@ -0,0 +1,78 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_THREAD_POOL_H_
+#define CONSOLE_THREAD_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "console/export.h"
+
+namespace console {
+
+// ThreadPool runs a batch of indexed tasks on a fixed set of threads.
+// Every thread, including the caller of ParallelFor(), owns a deque of
+// indices. It pops from the back of its own deque and, once that is empty,
+// steals from the front of the others. So a few slow tasks don't keep the
+// rest of the threads idle.
+class CONSOLE_EXPORT ThreadPool {
+ public:
+  // Starts |num_threads| worker threads. With 0, every task runs on the
+  // calling thread.
+  explicit ThreadPool(size_t num_threads);
+  ThreadPool(const ThreadPool& other) = delete;
+  ThreadPool& operator=(const ThreadPool& other) = delete;
+  ~ThreadPool();
+
+  // Returns a pool with a worker per hardware thread, besides the caller.
+  static ThreadPool* GetDefault();
+
+  size_t num_threads() const;
+
+  // Runs |task| for every index in [0, |n|) and returns once all of them
+  // are done. The calling thread runs tasks as well. Calls from multiple
+  // threads are serialized.
+  void ParallelFor(size_t n, const std::function<void(size_t)>& task);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<size_t> indices;
+  };
+
+  // Pops an index from |queues_[queue_index]|, or steals one from another
+  // queue. Returns false if every queue is empty.
+  bool PopOrSteal(size_t queue_index, size_t* index);
+  // Runs tasks until every queue is empty.
+  void RunTasks(size_t queue_index);
+  void RunWorker(size_t queue_index);
+
+  std::vector<std::thread> threads_;
+  // One per worker, and the last one for the caller of ParallelFor().
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  std::mutex parallel_for_mutex_;
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(size_t)>* task_ = nullptr;
+  uint64_t generation_ = 0;
+  size_t remaining_ = 0;
+  bool stopped_ = false;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_THREAD_POOL_H_
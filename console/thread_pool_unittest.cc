@@ -0,0 +1,39 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/thread_pool.h"
+
+#include <atomic>
+
+#include "gtest/gtest.h"
+
+namespace console {
+
+TEST(ThreadPoolTest, ParallelFor) {
+  for (size_t num_threads : {0, 1, 4}) {
+    ThreadPool thread_pool(num_threads);
+    EXPECT_EQ(thread_pool.num_threads(), num_threads);
+    for (size_t n : {0, 1, 7, 1000}) {
+      std::vector<std::atomic<int>> counts(n);
+      for (auto& count : counts) count.store(0);
+      thread_pool.ParallelFor(n, [&counts](size_t i) { counts[i]++; });
+      for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(counts[i].load(), 1);
+      }
+    }
+  }
+}
+
+TEST(ThreadPoolTest, UnevenTasks) {
+  ThreadPool thread_pool(3);
+  std::atomic<size_t> done{0};
+  // The first range is slow, so the others have to steal from it to finish.
+  thread_pool.ParallelFor(64, [&done](size_t i) {
+    if (i < 16) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    done++;
+  });
+  EXPECT_EQ(done.load(), 64);
+}
+
+}  // namespace console
@@ -0,0 +1,35 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/tick_clock.h"
+
+namespace console {
+
+TickClock::~TickClock() = default;
+
+DefaultTickClock::~DefaultTickClock() = default;
+
+// static
+const DefaultTickClock* DefaultTickClock::GetInstance() {
+  static DefaultTickClock* clock = new DefaultTickClock();
+  return clock;
+}
+
+TickClock::TimePoint DefaultTickClock::NowTicks() const {
+  return std::chrono::steady_clock::now();
+}
+
+VirtualTickClock::VirtualTickClock() = default;
+
+VirtualTickClock::~VirtualTickClock() = default;
+
+void VirtualTickClock::Advance(std::chrono::nanoseconds delta) {
+  now_ += delta;
+}
+
+void VirtualTickClock::SetNowTicks(TimePoint now) { now_ = now; }
+
+TickClock::TimePoint VirtualTickClock::NowTicks() const { return now_; }
+
+}  // namespace console
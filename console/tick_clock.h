@@ -0,0 +1,55 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_TICK_CLOCK_H_
+#define CONSOLE_TICK_CLOCK_H_
+
+#include <chrono>
+
+#include "console/export.h"
+
+namespace console {
+
+// TickClock is where the animation system reads the time from. It is
+// injected through RenderContext::set_tick_clock() and
+// AnimationScheduler::set_tick_clock(), so that tests and benchmarks can run
+// on a VirtualTickClock.
+class CONSOLE_EXPORT TickClock {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+
+  virtual ~TickClock();
+
+  virtual TimePoint NowTicks() const = 0;
+};
+
+// DefaultTickClock reads std::chrono::steady_clock.
+class CONSOLE_EXPORT DefaultTickClock : public TickClock {
+ public:
+  ~DefaultTickClock() override;
+
+  static const DefaultTickClock* GetInstance();
+
+  TimePoint NowTicks() const override;
+};
+
+// VirtualTickClock only moves when told to, which makes time deterministic.
+// It starts at TimePoint().
+class CONSOLE_EXPORT VirtualTickClock : public TickClock {
+ public:
+  VirtualTickClock();
+  ~VirtualTickClock() override;
+
+  void Advance(std::chrono::nanoseconds delta);
+  void SetNowTicks(TimePoint now);
+
+  TimePoint NowTicks() const override;
+
+ private:
+  TimePoint now_;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_TICK_CLOCK_H_
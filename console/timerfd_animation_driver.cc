@@ -0,0 +1,173 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/timerfd_animation_driver.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#include "console/tracing.h"
+
+namespace console {
+
+namespace {
+
+timespec ToTimespec(AnimationScheduler::Clock::time_point time_point) {
+  // steady_clock is CLOCK_MONOTONIC on Linux, which is also what the
+  // timerfd is created with.
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                time_point.time_since_epoch())
+                .count();
+  timespec ts;
+  ts.tv_sec = ns / 1000000000;
+  ts.tv_nsec = ns % 1000000000;
+  return ts;
+}
+
+}  // namespace
+
+TimerFdAnimationDriver::TimerFdAnimationDriver(int output_fd)
+    : output_fd_(output_fd),
+      scheduler_(&frame_target_),
+      next_deadline_(AnimationScheduler::Clock::time_point::max()) {}
+
+TimerFdAnimationDriver::~TimerFdAnimationDriver() {
+  if (epoll_fd_ >= 0) {
+    if (timer_fd_ >= 0) epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, timer_fd_, nullptr);
+    if (epollout_registered_) {
+      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, output_fd_, nullptr);
+    }
+  }
+  if (timer_fd_ >= 0) close(timer_fd_);
+  if (output_flags_ >= 0) fcntl(output_fd_, F_SETFL, output_flags_);
+}
+
+bool TimerFdAnimationDriver::Init() {
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timer_fd_ < 0) return false;
+
+  output_flags_ = fcntl(output_fd_, F_GETFL);
+  if (output_flags_ < 0) return false;
+  if (fcntl(output_fd_, F_SETFL, output_flags_ | O_NONBLOCK) < 0) {
+    output_flags_ = -1;
+    return false;
+  }
+  return true;
+}
+
+void TimerFdAnimationDriver::AddAnimation(std::unique_ptr<Animation> animation,
+                                          std::chrono::milliseconds interval) {
+  scheduler_.AddAnimation(std::move(animation), interval);
+  // The first frame of the new animation is due right now.
+  next_deadline_ = AnimationScheduler::Clock::now();
+  if (pending_.empty()) ArmTimer(next_deadline_);
+}
+
+bool TimerFdAnimationDriver::Attach(int epoll_fd) {
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = timer_fd_;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd_, &event) < 0) return false;
+  epoll_fd_ = epoll_fd;
+  return UpdateEpoll();
+}
+
+int TimerFdAnimationDriver::timer_fd() const { return timer_fd_; }
+
+int TimerFdAnimationDriver::output_fd() const { return output_fd_; }
+
+bool TimerFdAnimationDriver::Owns(int fd) const {
+  return fd == timer_fd_ || fd == output_fd_;
+}
+
+bool TimerFdAnimationDriver::wants_write() const { return !pending_.empty(); }
+
+bool TimerFdAnimationDriver::done() const {
+  return scheduler_.empty() && pending_.empty();
+}
+
+bool TimerFdAnimationDriver::Dispatch() {
+  CONSOLE_TRACE_EVENT("TimerFdAnimationDriver::Dispatch");
+  uint64_t expirations;
+  if (read(timer_fd_, &expirations, sizeof(expirations)) < 0 &&
+      errno != EAGAIN) {
+    return false;
+  }
+
+  if (!WritePending()) return false;
+
+  // While the terminal is backed up, no frame is rendered. The scheduler
+  // skips the missed ones once it catches up.
+  auto now = AnimationScheduler::Clock::now();
+  if (pending_.empty() && now >= next_deadline_) {
+    next_deadline_ = scheduler_.Tick(now);
+    pending_.assign(frame_target_.buffer());
+    pending_offset_ = 0;
+    frame_target_.Clear();
+    if (!WritePending()) return false;
+  }
+
+  if (pending_.empty()) {
+    if (!ArmTimer(next_deadline_)) return false;
+  }
+  return UpdateEpoll();
+}
+
+bool TimerFdAnimationDriver::WritePending() {
+  while (pending_offset_ < pending_.size()) {
+    ssize_t written = write(output_fd_, pending_.data() + pending_offset_,
+                            pending_.size() - pending_offset_);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+      return false;
+    }
+    pending_offset_ += written;
+  }
+  pending_.clear();
+  pending_offset_ = 0;
+  return true;
+}
+
+bool TimerFdAnimationDriver::ArmTimer(
+    AnimationScheduler::Clock::time_point deadline) {
+  itimerspec spec = {};
+  if (deadline != AnimationScheduler::Clock::time_point::max()) {
+    spec.it_value = ToTimespec(deadline);
+    // A zero |it_value| disarms the timer.
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+      spec.it_value.tv_nsec = 1;
+    }
+  }
+  return timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) == 0;
+}
+
+bool TimerFdAnimationDriver::UpdateEpoll() {
+  if (epoll_fd_ < 0) return true;
+  if (wants_write() == epollout_registered_) return true;
+
+  if (wants_write()) {
+    epoll_event event = {};
+    event.events = EPOLLOUT;
+    event.data.fd = output_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, output_fd_, &event) < 0) {
+      return false;
+    }
+  } else {
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, output_fd_, nullptr) < 0) {
+      return false;
+    }
+  }
+  epollout_registered_ = wants_write();
+  return true;
+}
+
+}  // namespace console
+
+#endif  // defined(__linux__)
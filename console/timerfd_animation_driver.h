@@ -0,0 +1,106 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_TIMERFD_ANIMATION_DRIVER_H_
+#define CONSOLE_TIMERFD_ANIMATION_DRIVER_H_
+
+// timerfd is only available on Linux.
+#if defined(__linux__)
+
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "console/animation.h"
+#include "console/animation_scheduler.h"
+#include "console/export.h"
+#include "console/render_target.h"
+
+namespace console {
+
+// TimerFdAnimationDriver drives animations from an existing event loop
+// instead of a dedicated thread. It exposes a timerfd which becomes readable
+// when the next frame is due, and Dispatch() which renders it.
+//
+// Frames are rendered into memory and written to |output_fd| without
+// blocking. If the terminal is backed up, the rest is kept until the fd
+// becomes writable, and no new frame is rendered in the meantime. The
+// scheduler skips the frames missed while waiting.
+//
+// int epoll_fd = epoll_create1(0);
+// TimerFdAnimationDriver driver;
+// driver.Init();
+// driver.AddAnimation(std::move(animation), std::chrono::milliseconds(100));
+// driver.Attach(epoll_fd);
+// while (true) {
+//   epoll_event events[16];
+//   int n = epoll_wait(epoll_fd, events, 16, -1);
+//   for (int i = 0; i < n; ++i) {
+//     if (driver.Owns(events[i].data.fd)) driver.Dispatch();
+//     ...
+//   }
+// }
+class CONSOLE_EXPORT TimerFdAnimationDriver {
+ public:
+  // |output_fd| is switched to non-blocking mode until the driver is
+  // destroyed. Note that it affects every writer sharing the file
+  // description, such as std::cout for STDOUT_FILENO.
+  explicit TimerFdAnimationDriver(int output_fd = STDOUT_FILENO);
+  TimerFdAnimationDriver(const TimerFdAnimationDriver& other) = delete;
+  TimerFdAnimationDriver& operator=(const TimerFdAnimationDriver& other) =
+      delete;
+  ~TimerFdAnimationDriver();
+
+  // Creates the timerfd. Returns false on failure.
+  bool Init();
+
+  void AddAnimation(std::unique_ptr<Animation> animation,
+                    std::chrono::milliseconds interval);
+
+  // Registers timer_fd() for EPOLLIN to |epoll_fd|. From then on, Dispatch()
+  // registers and unregisters output_fd() for EPOLLOUT as needed. Both are
+  // registered with epoll_event::data::fd set to the fd.
+  bool Attach(int epoll_fd);
+
+  int timer_fd() const;
+  int output_fd() const;
+  // Returns true if |fd| is either timer_fd() or output_fd().
+  bool Owns(int fd) const;
+  // Returns true if there's output waiting for output_fd() to be writable.
+  bool wants_write() const;
+  // Returns true if there's no animation left and everything was written.
+  bool done() const;
+
+  // Call this when timer_fd() is readable or output_fd() is writable.
+  // It writes pending output, renders the due frames and re-arms the timer.
+  // Returns false on an unrecoverable error.
+  bool Dispatch();
+
+ private:
+  // Writes as much of |pending_| as possible. Returns false on errors other
+  // than EAGAIN.
+  bool WritePending();
+  bool ArmTimer(AnimationScheduler::Clock::time_point deadline);
+  bool UpdateEpoll();
+
+  int output_fd_;
+  int output_flags_ = -1;
+  int timer_fd_ = -1;
+  int epoll_fd_ = -1;
+  bool epollout_registered_ = false;
+
+  BufferRenderTarget frame_target_;
+  AnimationScheduler scheduler_;
+  AnimationScheduler::Clock::time_point next_deadline_;
+  std::string pending_;
+  size_t pending_offset_ = 0;
+};
+
+}  // namespace console
+
+#endif  // defined(__linux__)
+
+#endif  // CONSOLE_TIMERFD_ANIMATION_DRIVER_H_
@@ -0,0 +1,138 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/timerfd_animation_driver.h"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "console/sgr_parameters.h"
+#include "gtest/gtest.h"
+
+namespace console {
+
+namespace {
+
+class PrintingAnimation : public Animation {
+ public:
+  explicit PrintingAnimation(size_t total_frames)
+      : total_frames_(total_frames) {}
+
+ private:
+  bool ShouldUpdate() override { return true; }
+
+  void DoUpdate(RenderContext* context) override {
+    context->ostream() << current_frame_;
+    if (current_frame_ + 1 == total_frames_) ended_ = true;
+  }
+
+  size_t total_frames_;
+};
+
+class LargeAnimation : public Animation {
+ public:
+  explicit LargeAnimation(const std::string& text) : text_(text) {}
+
+ private:
+  bool ShouldUpdate() override { return true; }
+
+  void DoUpdate(RenderContext* context) override {
+    context->stream().Write(text_);
+    ended_ = true;
+  }
+
+  std::string text_;
+};
+
+std::string ReadAll(int fd) {
+  std::string ret;
+  char buf[256];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0) ret.append(buf, n);
+  return ret;
+}
+
+}  // namespace
+
+TEST(TimerFdAnimationDriverTest, Dispatch) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  int epoll_fd = epoll_create1(0);
+  ASSERT_GE(epoll_fd, 0);
+
+  {
+    TimerFdAnimationDriver driver(fds[1]);
+    ASSERT_TRUE(driver.Init());
+    driver.AddAnimation(
+        std::unique_ptr<Animation>(new PrintingAnimation(3)),
+        std::chrono::milliseconds(1));
+    ASSERT_TRUE(driver.Attach(epoll_fd));
+
+    while (!driver.done()) {
+      epoll_event events[4];
+      int n = epoll_wait(epoll_fd, events, 4, 1000);
+      ASSERT_GT(n, 0);
+      for (int i = 0; i < n; ++i) {
+        EXPECT_TRUE(driver.Owns(events[i].data.fd));
+        ASSERT_TRUE(driver.Dispatch());
+      }
+    }
+  }
+
+  close(fds[1]);
+  // Every frame ends with a reset.
+  std::string reset(kReset);
+  EXPECT_EQ(ReadAll(fds[0]), "0" + reset + "1" + reset + "2" + reset);
+  close(fds[0]);
+  close(epoll_fd);
+}
+
+TEST(TimerFdAnimationDriverTest, ContinueOnWritable) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  // Makes the pipe back up after a single frame.
+  ASSERT_GT(fcntl(fds[1], F_SETPIPE_SZ, 4096), 0);
+  int epoll_fd = epoll_create1(0);
+  ASSERT_GE(epoll_fd, 0);
+
+  std::string text(3 * 4096, 'a');
+  std::string written;
+  {
+    TimerFdAnimationDriver driver(fds[1]);
+    ASSERT_TRUE(driver.Init());
+    driver.AddAnimation(std::unique_ptr<Animation>(new LargeAnimation(text)),
+                        std::chrono::milliseconds(1));
+    ASSERT_TRUE(driver.Attach(epoll_fd));
+
+    epoll_event event;
+    ASSERT_EQ(epoll_wait(epoll_fd, &event, 1, 1000), 1);
+    ASSERT_TRUE(driver.Dispatch());
+    EXPECT_TRUE(driver.wants_write());
+    EXPECT_FALSE(driver.done());
+
+    while (!driver.done()) {
+      char buf[4096];
+      ssize_t n = read(fds[0], buf, sizeof(buf));
+      ASSERT_GT(n, 0);
+      written.append(buf, n);
+      ASSERT_EQ(epoll_wait(epoll_fd, &event, 1, 1000), 1);
+      EXPECT_EQ(event.data.fd, driver.output_fd());
+      ASSERT_TRUE(driver.Dispatch());
+    }
+  }
+  close(fds[1]);
+  written += ReadAll(fds[0]);
+  EXPECT_EQ(written, text + kReset);
+  close(fds[0]);
+  close(epoll_fd);
+}
+
+}  // namespace console
+
+#endif  // defined(__linux__)
@@ -0,0 +1,227 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/tracing.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace console {
+
+namespace {
+
+struct TraceEvent {
+  // Odd while the owner thread is writing the slot, and even otherwise.
+  std::atomic<uint64_t> sequence{0};
+  std::atomic<const char*> name{nullptr};
+  std::atomic<uint64_t> timestamp_ns{0};
+  std::atomic<char> phase{0};
+};
+
+// Single producer ring buffer. Only the owner thread writes to it, so
+// recording doesn't need any lock. Readers detect slots being overwritten
+// by checking |sequence| before and after copying them.
+class ThreadBuffer {
+ public:
+  explicit ThreadBuffer(int tid)
+      : tid_(tid), events_(Tracer::kEventsPerThread) {}
+
+  void Add(const char* name, char phase, uint64_t timestamp_ns) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    TraceEvent& event = events_[head % events_.size()];
+    uint64_t sequence = event.sequence.load(std::memory_order_relaxed);
+    event.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name, std::memory_order_relaxed);
+    event.timestamp_ns.store(timestamp_ns, std::memory_order_relaxed);
+    event.phase.store(phase, std::memory_order_relaxed);
+    event.sequence.store(sequence + 2, std::memory_order_release);
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  template <typename Callback>
+  void ForEach(Callback callback) const {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t begin = cleared_.load(std::memory_order_relaxed);
+    if (head - begin > events_.size()) begin = head - events_.size();
+    for (uint64_t i = begin; i < head; ++i) {
+      const TraceEvent& event = events_[i % events_.size()];
+      uint64_t sequence = event.sequence.load(std::memory_order_acquire);
+      if (sequence % 2 != 0) continue;
+      const char* name = event.name.load(std::memory_order_relaxed);
+      uint64_t timestamp_ns =
+          event.timestamp_ns.load(std::memory_order_relaxed);
+      char phase = event.phase.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (event.sequence.load(std::memory_order_relaxed) != sequence) continue;
+      callback(name, phase, timestamp_ns);
+    }
+  }
+
+  void Clear() {
+    cleared_.store(head_.load(std::memory_order_acquire),
+                   std::memory_order_relaxed);
+  }
+
+  int tid() const { return tid_; }
+
+ private:
+  const int tid_;
+  std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> cleared_{0};
+  std::vector<TraceEvent> events_;
+};
+
+struct Registry {
+  std::mutex mutex;
+  // Buffers are never freed, so that events of the exited threads can be
+  // still written out.
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  std::string at_exit_filename;
+};
+
+std::atomic<bool> g_enabled{false};
+
+Registry& GetRegistry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+ThreadBuffer* GetThreadBuffer() {
+  thread_local ThreadBuffer* buffer = nullptr;
+  if (!buffer) {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.buffers.emplace_back(
+        new ThreadBuffer(static_cast<int>(registry.buffers.size()) + 1));
+    buffer = registry.buffers.back().get();
+  }
+  return buffer;
+}
+
+uint64_t NowInNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int GetPid() {
+#if defined(_WIN32)
+  return _getpid();
+#else
+  return getpid();
+#endif
+}
+
+void WriteJsonString(std::ostream& ostream, absl::string_view text) {
+  ostream << '"';
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      ostream << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      ostream << ' ';
+    } else {
+      ostream << c;
+    }
+  }
+  ostream << '"';
+}
+
+void WriteJsonAtExit() {
+  const std::string& filename = GetRegistry().at_exit_filename;
+  if (!filename.empty()) Tracer::WriteJsonToFile(filename);
+}
+
+}  // namespace
+
+constexpr size_t Tracer::kEventsPerThread;
+
+// static
+void Tracer::Start() { g_enabled.store(true, std::memory_order_relaxed); }
+
+// static
+void Tracer::Stop() { g_enabled.store(false, std::memory_order_relaxed); }
+
+// static
+bool Tracer::IsEnabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+// static
+void Tracer::AddEvent(const char* name, char phase) {
+  GetThreadBuffer()->Add(name, phase, NowInNanoseconds());
+}
+
+// static
+void Tracer::WriteJson(std::ostream& ostream) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  int pid = GetPid();
+  bool first = true;
+  ostream << "{\"traceEvents\":[";
+  for (auto& buffer : registry.buffers) {
+    int tid = buffer->tid();
+    buffer->ForEach([&ostream, &first, pid, tid](const char* name, char phase,
+                                                  uint64_t timestamp_ns) {
+      if (!first) ostream << ",";
+      first = false;
+      ostream << "\n{\"name\":";
+      WriteJsonString(ostream, name);
+      ostream << absl::StrFormat(
+          ",\"cat\":\"console\",\"ph\":\"%c\",\"ts\":%d.%03d,\"pid\":%d,"
+          "\"tid\":%d}",
+          phase, timestamp_ns / 1000, timestamp_ns % 1000, pid, tid);
+    });
+  }
+  ostream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+// static
+bool Tracer::WriteJsonToFile(absl::string_view filename) {
+  std::ofstream ofs(std::string(filename).c_str());
+  if (!ofs.good()) return false;
+  WriteJson(ofs);
+  return ofs.good();
+}
+
+// static
+void Tracer::WriteJsonToFileAtExit(absl::string_view filename) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  if (registry.at_exit_filename.empty()) std::atexit(&WriteJsonAtExit);
+  registry.at_exit_filename = std::string(filename);
+}
+
+// static
+void Tracer::Clear() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto& buffer : registry.buffers) {
+    buffer->Clear();
+  }
+}
+
+ScopedTraceEvent::ScopedTraceEvent(const char* name)
+    : name_(Tracer::IsEnabled() ? name : nullptr) {
+  if (name_) Tracer::AddEvent(name_, 'B');
+}
+
+ScopedTraceEvent::~ScopedTraceEvent() {
+  if (name_) Tracer::AddEvent(name_, 'E');
+}
+
+}  // namespace console
@@ -0,0 +1,76 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_TRACING_H_
+#define CONSOLE_TRACING_H_
+
+#include <stddef.h>
+
+#include <ostream>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "console/export.h"
+
+// Trace events are opt-in. Build with -DCONSOLE_ENABLE_TRACING to record
+// them, otherwise CONSOLE_TRACE_EVENT expands to nothing. Even when compiled
+// in, nothing is recorded until Tracer::Start() is called.
+#define CONSOLE_TRACE_CONCAT_INTERNAL(a, b) a##b
+#define CONSOLE_TRACE_CONCAT(a, b) CONSOLE_TRACE_CONCAT_INTERNAL(a, b)
+
+#if defined(CONSOLE_ENABLE_TRACING)
+// Records a begin event for |name| now and an end event at the end of the
+// enclosing scope. |name| must be a string literal.
+#define CONSOLE_TRACE_EVENT(name) \
+  ::console::ScopedTraceEvent CONSOLE_TRACE_CONCAT(trace_event_, __LINE__)(name)
+#else
+#define CONSOLE_TRACE_EVENT(name)
+#endif
+
+namespace console {
+
+// Tracer records begin/end events into a per thread ring buffer and writes
+// them in the Chrome trace event format, which can be loaded into
+// chrome://tracing or https://ui.perfetto.dev.
+//
+// Recording is lock free: each thread only writes to its own buffer, and once
+// it is full, the oldest events are overwritten.
+class CONSOLE_EXPORT Tracer {
+ public:
+  // The number of events each thread keeps.
+  static constexpr size_t kEventsPerThread = 16384;
+
+  static void Start();
+  static void Stop();
+  static bool IsEnabled();
+
+  // Records an event with |phase| of 'B'(begin) or 'E'(end). |name| must
+  // outlive the tracer, in other words, it should be a string literal.
+  static void AddEvent(const char* name, char phase);
+
+  // Writes all the recorded events as Chrome trace JSON.
+  static void WriteJson(std::ostream& ostream);
+  static bool WriteJsonToFile(absl::string_view filename);
+  // Calls WriteJsonToFile(|filename|) when the process exits.
+  static void WriteJsonToFileAtExit(absl::string_view filename);
+
+  // Drops all the recorded events.
+  static void Clear();
+};
+
+class CONSOLE_EXPORT ScopedTraceEvent {
+ public:
+  explicit ScopedTraceEvent(const char* name);
+  ScopedTraceEvent(const ScopedTraceEvent& other) = delete;
+  ScopedTraceEvent& operator=(const ScopedTraceEvent& other) = delete;
+  ~ScopedTraceEvent();
+
+ private:
+  // nullptr if tracing was disabled at construction.
+  const char* name_;
+};
+
+}  // namespace console
+
+#endif  // CONSOLE_TRACING_H_
@@ -0,0 +1,40 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console/tracing.h"
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+namespace console {
+
+TEST(TracerTest, WriteJson) {
+  Tracer::Clear();
+  {
+    Tracer::Start();
+    ScopedTraceEvent event("TracerTest");
+    Tracer::Stop();
+  }
+  { ScopedTraceEvent event("Ignored"); }
+
+  std::stringstream ss;
+  Tracer::WriteJson(ss);
+  std::string json = ss.str();
+  EXPECT_EQ(json.find("{\"traceEvents\":["), 0);
+  EXPECT_NE(json.find("{\"name\":\"TracerTest\",\"cat\":\"console\","
+                      "\"ph\":\"B\""),
+            std::string::npos);
+  EXPECT_NE(json.find("{\"name\":\"TracerTest\",\"cat\":\"console\","
+                      "\"ph\":\"E\""),
+            std::string::npos);
+  EXPECT_EQ(json.find("Ignored"), std::string::npos);
+
+  Tracer::Clear();
+  ss.str("");
+  Tracer::WriteJson(ss);
+  EXPECT_EQ(ss.str().find("TracerTest"), std::string::npos);
+}
+
+}  // namespace console
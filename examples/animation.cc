@@ -2,14 +2,18 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdio.h>
+
 #include <chrono>
 #include <iostream>
 #include <memory>
-#include <thread>
 
 #include "color/colormap.h"
 #include "color/named_color.h"
+#include "console/adaptive_quality.h"
 #include "console/animation.h"
+#include "console/animation_scheduler.h"
+#include "console/color_timeline.h"
 #include "console/stream.h"
 
 int main() {
@@ -17,19 +21,32 @@ int main() {
   console::Console::EnableAnsi(std::cout);
 #endif
 
-  console::Stream stream;
+  // Lowers colors, frame rate and the number of animated rows when stdout
+  // can't keep up, for example over a slow SSH connection.
+  console::AdaptiveQualityController controller;
+  controller.set_fd(fileno(stdout));
+  console::AdaptiveQualityController::SetCurrent(&controller);
+
   color::Colormap colormap;
-  std::vector<color::Rgb> rainbow_colors, grayscale_colors;
-  colormap.Rainbow(30, &rainbow_colors);
+  std::vector<color::Rgb> grayscale_colors;
   colormap.Greys(5, &grayscale_colors);
 
+  // A loop of 30 frames through a few colors.
+  console::ColorTimeline rainbow_timeline;
+  rainbow_timeline.AddKeyframe(0, color::kRed);
+  rainbow_timeline.AddKeyframe(8, color::kOrange);
+  rainbow_timeline.AddKeyframe(15, color::kPurple,
+                               console::ColorTimeline::Easing::kEaseInOut);
+  rainbow_timeline.AddKeyframe(23, color::kBlue);
+  rainbow_timeline.AddKeyframe(30, color::kRed);
+
   const char* text =
       "Lorem ipsum dolor sit amet, consectetur adipiscing elit\n";
 
   std::unique_ptr<console::FlowTextAnimation> flow_animation(
       new console::FlowTextAnimation());
   flow_animation->set_repeat(true);
-  flow_animation->set_colors(rainbow_colors);
+  flow_animation->set_timeline(rainbow_timeline);
   flow_animation->set_text(text);
   flow_animation->set_on_animation_will_update(
       [](size_t) { std::cout << "flow animation: "; });
@@ -54,22 +71,21 @@ int main() {
   radar_animation->set_text(text);
   radar_animation->set_on_animation_will_update(
       [](size_t) { std::cout << "radar animation: "; });
-  console::AnimationGroup group;
-  group.AddAnimation(std::move(flow_animation));
-  group.AddAnimation(std::move(neon_animation));
-  group.AddAnimation(std::move(karaoke_animation));
-  group.AddAnimation(std::move(radar_animation));
-  group.set_on_animation_will_update([](size_t framenum) {
+  std::unique_ptr<console::AnimationGroup> group(new console::AnimationGroup());
+  group->AddAnimation(std::move(flow_animation));
+  group->AddAnimation(std::move(neon_animation));
+  group->AddAnimation(std::move(karaoke_animation));
+  group->AddAnimation(std::move(radar_animation));
+  group->set_on_animation_will_update([](size_t framenum) {
     if (framenum == 0) return;
     console::Stream stream;
     stream.CursorUp(4);
     stream.EraseEndOfLine();
   });
 
-  while (true) {
-    group.Update();
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-  }
+  console::AnimationScheduler scheduler;
+  scheduler.AddAnimation(std::move(group), std::chrono::milliseconds(100));
+  scheduler.Run();
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,147 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how many frames per second each animation renders, without a
+// terminal. The output is discarded and the frames are stepped on a virtual
+// clock, so the numbers only depend on the rendering itself.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "color/colormap.h"
+#include "color/named_color.h"
+#include "console/animation.h"
+#include "console/animation_pool.h"
+#include "console/color_timeline.h"
+#include "console/headless_runner.h"
+
+namespace {
+
+const char kText[] = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+
+struct Benchmark {
+  const char* name;
+  std::function<std::unique_ptr<console::Animation>()> create;
+};
+
+std::unique_ptr<console::Animation> CreateFlow() {
+  color::Colormap colormap;
+  std::vector<color::Rgb> colors;
+  colormap.Rainbow(30, &colors);
+  std::unique_ptr<console::FlowTextAnimation> animation(
+      new console::FlowTextAnimation());
+  animation->set_colors(colors);
+  animation->set_text(kText);
+  return animation;
+}
+
+std::unique_ptr<console::Animation> CreateFlowTimeline() {
+  console::ColorTimeline timeline;
+  timeline.AddKeyframe(0, color::kRed);
+  timeline.AddKeyframe(15, color::kBlue,
+                       console::ColorTimeline::Easing::kEaseInOut);
+  timeline.AddKeyframe(30, color::kRed);
+  std::unique_ptr<console::FlowTextAnimation> animation(
+      new console::FlowTextAnimation());
+  animation->set_timeline(timeline);
+  animation->set_text(kText);
+  return animation;
+}
+
+std::unique_ptr<console::Animation> CreateNeon() {
+  std::unique_ptr<console::NeonTextAnimation> animation(
+      new console::NeonTextAnimation());
+  animation->set_colors({color::kPurple, color::kGray});
+  animation->set_text(kText);
+  return animation;
+}
+
+std::unique_ptr<console::Animation> CreateKaraoke() {
+  std::unique_ptr<console::KaraokeTextAnimation> animation(
+      new console::KaraokeTextAnimation());
+  animation->set_color(color::kOrange);
+  animation->set_text(kText);
+  return animation;
+}
+
+std::unique_ptr<console::Animation> CreateRadar() {
+  color::Colormap colormap;
+  std::vector<color::Rgb> colors;
+  colormap.Greys(5, &colors);
+  std::unique_ptr<console::RadarTextAnimation> animation(
+      new console::RadarTextAnimation());
+  animation->set_colors(colors);
+  animation->set_text(kText);
+  return animation;
+}
+
+// A grid of |kGridSize| cells as an AnimationGroup of TextAnimations and as
+// an AnimationPool.
+constexpr size_t kGridSize = 10000;
+
+std::unique_ptr<console::Animation> CreateGroupGrid() {
+  std::unique_ptr<console::AnimationGroup> group(
+      new console::AnimationGroup());
+  for (size_t i = 0; i < kGridSize; ++i) {
+    std::unique_ptr<console::NeonTextAnimation> animation(
+        new console::NeonTextAnimation());
+    animation->set_colors({color::kPurple, color::kGray});
+    animation->set_text(i % 100 == 99 ? "OK\n" : "OK ");
+    animation->set_repeat(true);
+    group->AddAnimation(std::move(animation));
+  }
+  return group;
+}
+
+std::unique_ptr<console::Animation> CreatePoolGrid() {
+  std::unique_ptr<console::AnimationPool> pool(new console::AnimationPool());
+  uint32_t palette = pool->AddPalette({color::kPurple, color::kGray});
+  for (size_t i = 0; i < kGridSize; ++i) {
+    pool->Add(console::AnimationPool::Effect::kNeon,
+              i % 100 == 99 ? "OK\n" : "OK ", palette, true);
+  }
+  return pool;
+}
+
+void Run(const Benchmark& benchmark, size_t frames) {
+  std::unique_ptr<console::Animation> animation = benchmark.create();
+  animation->set_repeat(true);
+  console::HeadlessRunner runner;
+  runner.AddAnimation(std::move(animation), std::chrono::milliseconds(16));
+  console::HeadlessRunner::Result result = runner.Run(frames);
+  printf("%-16s %12.1f %14.1f\n", benchmark.name, result.GetTicksPerSecond(),
+         static_cast<double>(runner.bytes_discarded()) / result.ticks);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t frames = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+
+  const Benchmark kBenchmarks[] = {
+      {"flow", CreateFlow},       {"flow (timeline)", CreateFlowTimeline},
+      {"neon", CreateNeon},       {"karaoke", CreateKaraoke},
+      {"radar", CreateRadar},
+  };
+  const Benchmark kGridBenchmarks[] = {
+      {"group", CreateGroupGrid},
+      {"pool", CreatePoolGrid},
+  };
+
+  printf("%-16s %12s %14s\n", "animation", "frames/s", "bytes/frame");
+  for (const Benchmark& benchmark : kBenchmarks) {
+    Run(benchmark, frames);
+  }
+  printf("\n%zu cells\n", kGridSize);
+  for (const Benchmark& benchmark : kGridBenchmarks) {
+    Run(benchmark, std::max<size_t>(frames / kGridSize, 1));
+  }
+  return 0;
+}
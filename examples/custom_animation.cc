@@ -19,16 +19,17 @@ class ProgressAnimation : public console::Animation {
  private:
   bool ShouldUpdate() override { return current_frame_ < total_frames_; }
 
-  void DoUpdate() override {
+  void DoUpdate(console::RenderContext* context) override {
+    std::ostream& ostream = context->ostream();
     int did = static_cast<double>(current_frame_ + 1) / total_frames_ * 50;
     for (int i = 0; i < did; ++i) {
-      std::cout << "=";
+      ostream << "=";
     }
-    std::cout << ">";
+    ostream << ">";
     for (int i = 0; i < 50 - did; ++i) {
-      std::cout << " ";
+      ostream << " ";
     }
-    std::cout << "[" << (current_frame_ + 1) << " / " << total_frames_ << "]\n";
+    ostream << "[" << (current_frame_ + 1) << " / " << total_frames_ << "]\n";
   }
 
   size_t total_frames_;
@@ -0,0 +1,66 @@
+// Copyright (c) 2020 The Console Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how long FlagParser::Parse() takes for a command line of many
+// arguments, with a parser of many flags.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "console/flag.h"
+
+namespace {
+
+constexpr int kFlags = 1000;
+constexpr int kArguments = 10000;
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 20;
+
+  std::vector<int32_t> values(kFlags);
+  console::FlagParser parser;
+  for (int i = 0; i < kFlags; ++i) {
+    parser.AddFlag<console::Int32Flag>(&values[i])
+        .set_long_name(absl::StrFormat("--flag%d", i))
+        .set_short_name(absl::StrFormat("-f%d", i));
+  }
+
+  // Half of the arguments are "--flagN=N" and the other half are "-fN N",
+  // spread over all the flags.
+  std::vector<std::string> arguments;
+  arguments.push_back("flag_benchmark");
+  for (int i = 0; arguments.size() <= kArguments; ++i) {
+    int flag = (i * 7919) % kFlags;
+    if (i % 2 == 0) {
+      arguments.push_back(absl::StrFormat("--flag%d=%d", flag, i));
+    } else {
+      arguments.push_back(absl::StrFormat("-f%d", flag));
+      arguments.push_back(absl::StrFormat("%d", i));
+    }
+  }
+  std::vector<char*> args;
+  for (std::string& argument : arguments) args.push_back(&argument[0]);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    if (!parser.Parse(static_cast<int>(args.size()), args.data())) {
+      fprintf(stderr, "%s\n", parser.error_message().c_str());
+      return 1;
+    }
+  }
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  printf("%d flags, %zu arguments\n", kFlags, args.size() - 1);
+  printf("%.3f ms/parse, %.1f ns/argument\n", elapsed.count() / iterations,
+         elapsed.count() * 1e6 / iterations / (args.size() - 1));
+  return 0;
+}